@@ -17,8 +17,8 @@
 using namespace jetcash;
 using namespace platform;
 
-static const std::string previous_versions[] = {"B"};  // most recent previous version should be first in list
-static const std::string version_current     = "1";
+static const std::string previous_versions[] = {"1", "B"};  // most recent previous version should be first in list
+static const std::string version_current     = "2";
 // We increment when making incompatible changes to indices.
 
 // We use suffixes so all keys related to the same block are close to each other
@@ -27,9 +27,13 @@ static const std::string BLOCK_PREFIX           = "b";
 static const std::string BLOCK_SUFFIX           = "b";
 static const std::string HEADER_PREFIX          = "b";
 static const std::string HEADER_SUFFIX          = "h";
+static const std::string LONG_HASH_SUFFIX       = "w";  // PoW hash of block, kept across DB version changes
 static const std::string TRANSATION_PREFIX      = "t";
 static const size_t TRANSACTION_PREFIX_BYTES    = 5;  // We store only first bytes of tx hash in index
-static const std::string TIP_CHAIN_PREFIX       = "c";
+static const size_t MAX_HEADER_CACHE            = 100000;  // Kept across commits, cleared only when too large
+static const std::string TIP_CHAIN_PREFIX       = "c";  // only for chains of previous versions
+static const std::string TIP_CHAIN_TABLE        = "chain";  // height -> bid of main chain
+static const std::string IMPORT_CHAIN_TABLE     = "import";  // main chain of previous version, for internal import
 static const std::string TIMESTAMP_BLOCK_PREFIX = "T";
 
 static const std::string CHILDREN_PREFIX = "x-ch/";
@@ -95,7 +99,10 @@ PreparedBlock::PreparedBlock(RawBlock &&rba, crypto::CryptoNightContext *context
 }
 
 BlockChain::BlockChain(const Hash &genesis_bid, const std::string &coin_folder)
-    : m_genesis_bid(genesis_bid), m_coin_folder(coin_folder), m_db(coin_folder + "/blockchain") {
+    : m_genesis_bid(genesis_bid), m_coin_folder(coin_folder)
+    , m_db(coin_folder + "/blockchain")
+    , m_chain_table(m_db.open_table(TIP_CHAIN_TABLE))
+    , m_import_table(m_db.open_table(IMPORT_CHAIN_TABLE)) {
 	std::string version;
 	m_db.get("$version", version);
 	if (version != version_current) {
@@ -107,13 +114,34 @@ BlockChain::BlockChain(const Hash &genesis_bid, const std::string &coin_folder)
 		          << ", deleting jetcashd cache..." << std::endl;
 		}
 
-		std::set<Hash> main_chain_bids;
-		for (Height ha = 1;; ha += 1) {
-			BinaryArray ba;
-			if (!m_db.get(TIP_CHAIN_PREFIX + previous_versions[0] + "/" + common::write_varint_sqlite4(ha), ba))
+		// Main chain of previous version becomes import chain, unless previous internal import was not finished
+		Height import_height = 0;
+		BinaryArray import_ba;
+		if (!m_db.get_last(m_import_table, import_height, import_ba)) {
+			for (Height ha = 0;; ha += 1) {
+				DB::Value va;
+				if (!m_db.get(m_chain_table, ha, va))
+					break;
+				m_db.put(m_import_table, ha, BinaryArray(va.data(), va.data() + va.size()), true);
+			}
+			for (Height ha = 0;; ha += 1) {  // versions before chain table
+				BinaryArray ba;
+				if (!m_db.get(TIP_CHAIN_PREFIX + previous_versions[0] + "/" + common::write_varint_sqlite4(ha), ba)) {
+					if (ha == 0)
+						continue;  // genesis is added by BlockChainState, so it was not always in chain
+					break;
+				}
+				m_db.put(m_import_table, ha, ba, false);
+			}
+		}
+		clear_table(m_chain_table);
+		std::set<Hash> main_chain_bids{genesis_bid};
+		for (Height ha = 1;; ha += 1) {  // internal import starts after genesis
+			DB::Value va;
+			if (!m_db.get(m_import_table, ha, va))
 				break;
 			Hash bid;
-			seria::from_binary(bid, ba);
+			seria::from_binary(bid, va.data(), va.size());
 			main_chain_bids.insert(bid);
 		}
 		std::cout << "Found " << main_chain_bids.size() << " blocks from main chain" << std::endl;
@@ -123,19 +151,20 @@ BlockChain::BlockChain(const Hash &genesis_bid, const std::string &coin_folder)
 			if ((erased + skipped) % 1000000 == 0)
 				std::cout << "Processed " << (erased + skipped) / 1000000 << "/" << (total_items + 999999) / 1000000
 				          << " million DB records" << std::endl;
-			if (cur.get_suffix().find(TIP_CHAIN_PREFIX + previous_versions[0] + "/") == 0) {
+			if (cur.get_suffix().find(DB::TABLE_PREFIX) == 0) {
 				cur.next();
 				skipped += 1;
-				continue;  // chain
+				continue;  // sub-database, cannot be erased as a record
 			}
 			if (cur.get_suffix().find(BLOCK_PREFIX) == 0 &&
-			    cur.get_suffix().substr(cur.get_suffix().size() - BLOCK_SUFFIX.size()) == BLOCK_SUFFIX) {
+			    (cur.get_suffix().substr(cur.get_suffix().size() - BLOCK_SUFFIX.size()) == BLOCK_SUFFIX ||
+			        cur.get_suffix().substr(cur.get_suffix().size() - LONG_HASH_SUFFIX.size()) == LONG_HASH_SUFFIX)) {
 				Hash bid;
 				DB::from_binary_key(cur.get_suffix(), BLOCK_PREFIX.size(), bid.data, sizeof(bid.data));
 				if (main_chain_bids.count(bid) != 0) {
 					cur.next();
 					skipped += 1;
-					continue;  // block in main chain
+					continue;  // block in main chain or its long hash, so internal import does not hash again
 				}
 			}
 			cur.erase();
@@ -150,17 +179,20 @@ BlockChain::BlockChain(const Hash &genesis_bid, const std::string &coin_folder)
 		if (stored_genesis_bid != genesis_bid)
 			throw std::runtime_error("Database starts with different genesis_block");
 		read_tip();
+		m_committed_chain_size = m_tip_height + 1;
 	}
-	DB::Cursor cur2 = m_db.rbegin(TIP_CHAIN_PREFIX + previous_versions[0] + "/");
-	m_internal_import_known_height =
-	    cur2.end() ? 0 : boost::lexical_cast<Height>(common::read_varint_sqlite4(cur2.get_suffix()));
+	BinaryArray import_ba;
+	if (!m_db.get_last(m_import_table, m_internal_import_known_height, import_ba))
+		m_internal_import_known_height = 0;
 	//	test_print_structure();
 }
 
 void BlockChain::db_commit() {
 	std::cout << "BlockChain::db_commit started... tip_height=" << m_tip_height << " header_cache.size=" << header_cache.size() << std::endl;
 	m_db.commit_db_txn();
-	header_cache.clear();
+	m_committed_chain_size = m_tip_height + 1;
+	if (header_cache.size() > MAX_HEADER_CACHE)
+		header_cache.clear();
 	std::cout << "BlockChain::db_commit finished..." << std::endl;
 }
 
@@ -183,9 +215,12 @@ BroadcastAction BlockChain::add_block(const PreparedBlock &pb, api::BlockHeader
 	info.hash                = pb.bid;
 	info.height              = prev_info.height + 1;
 	// Rest fields are filled by check_standalone_consensus
-	if (!check_standalone_consensus(pb, info, prev_info))
+	Hash long_hash;
+	if (!check_standalone_consensus(pb, info, prev_info, long_hash))
 		return BroadcastAction::BAN;
 	try {
+		if (long_hash != Hash{})
+			store_long_hash(pb.bid, long_hash);
 		if (!have_block)
 			store_block(pb.bid, pb.block_data);  // Do not commit between here and
 		                                         // reorganize_blocks or invariant
@@ -426,6 +461,27 @@ void ser_members(APITransactionPos &v, ISeria &s) {
 }
 }  // namespace seria
 
+// Position and size of every transaction inside stored block data (see ser_members(RawBlock)), coinbase first.
+// Coinbase is inside block template, just before transaction hashes. Varints are canonical, so sizes are exact
+static std::vector<std::pair<size_t, size_t>> get_transaction_locators(const RawBlock &rb, const Block &block) {
+	std::vector<std::pair<size_t, size_t>> result;
+	result.reserve(rb.transactions.size() + 1);
+	const size_t block_pos     = common::get_varint_data(rb.block.size()).size();
+	const size_t hashes_size   = common::get_varint_data(block.header.transaction_hashes.size()).size() +
+	                           block.header.transaction_hashes.size() * sizeof(Hash);
+	const size_t coinbase_size = seria::binary_size(block.header.base_transaction);
+	if (rb.block.size() < hashes_size + coinbase_size)
+		throw std::logic_error("get_transaction_locators block template too small");
+	result.push_back(std::make_pair(block_pos + rb.block.size() - hashes_size - coinbase_size, coinbase_size));
+	size_t pos = block_pos + rb.block.size() + common::get_varint_data(rb.transactions.size()).size();
+	for (auto &&tx : rb.transactions) {
+		pos += common::get_varint_data(tx.size()).size();
+		result.push_back(std::make_pair(pos, tx.size()));
+		pos += tx.size();
+	}
+	return result;
+}
+
 bool BlockChain::read_transaction(const Hash &tid, Transaction &tx, Height &height, size_t &index_in_block) const {
 	auto txkey = TRANSATION_PREFIX + DB::to_binary_key(tid.data, TRANSACTION_PREFIX_BYTES);
 	for (DB::Cursor cur = m_db.begin(txkey); !cur.end(); cur.next()) {
@@ -437,6 +493,24 @@ bool BlockChain::read_transaction(const Hash &tid, Transaction &tx, Height &heig
 		Hash bid;
 		if (!read_chain(height, bid))
 			throw std::logic_error("transaction index corrupted while reading tid=" + common::pod_to_hex(tid));
+		const std::string locator = cur.get_value_string();
+		if (!locator.empty()) {  // Records written before locators were added are empty
+			const char *lbe  = locator.data();
+			const char *lend = lbe + locator.size();
+			const size_t pos = boost::lexical_cast<size_t>(common::read_varint_sqlite4(lbe, lend));
+			const size_t si  = boost::lexical_cast<size_t>(common::read_varint_sqlite4(lbe, lend));
+			DB::Value data;
+			platform::DBKey key(BLOCK_PREFIX);
+			key.append(bid.data, sizeof(bid.data)).append(BLOCK_SUFFIX);
+			if (!m_db.get(key.view(), data) || pos + si > data.size())
+				throw std::logic_error("transaction index corrupted while reading bid=" + common::pod_to_hex(bid));
+			Transaction candidate;
+			seria::from_binary(candidate, data.data() + pos, si);
+			if (get_transaction_hash(candidate) != tid)
+				continue;  // Other transaction with the same hash prefix
+			tx = std::move(candidate);
+			return true;
+		}
 		RawBlock rb;
 		Block block;
 		if (!read_block(bid, rb) || !block.from_raw_block(rb))
@@ -455,22 +529,25 @@ bool BlockChain::read_transaction(const Hash &tid, Transaction &tx, Height &heig
 	return false;
 }
 
-bool BlockChain::redo_block(const Hash &bhash, const RawBlock &, const Block &block, const api::BlockHeader &info,
-    const Hash &base_transaction_hash) {
+bool BlockChain::redo_block(const Hash &bhash, const RawBlock &raw_block, const Block &block,
+    const api::BlockHeader &info, const Hash &base_transaction_hash) {
 	if (!redo_block(bhash, block, info))
 		return false;
 	auto tikey = TIMESTAMP_BLOCK_PREFIX + common::write_varint_sqlite4(info.timestamp) +
 	             common::write_varint_sqlite4(info.height);
 	m_db.put(tikey, std::string(), true);
 
+	const auto locators = get_transaction_locators(raw_block, block);
 	auto bkey = TRANSATION_PREFIX + DB::to_binary_key(base_transaction_hash.data, TRANSACTION_PREFIX_BYTES) +
 	            common::write_varint_sqlite4(info.height) + common::write_varint_sqlite4(0);
-	m_db.put(bkey, std::string(), true);
+	m_db.put(bkey,
+	    common::write_varint_sqlite4(locators.at(0).first) + common::write_varint_sqlite4(locators.at(0).second), true);
 	for (size_t tx_index = 0; tx_index != block.transactions.size(); ++tx_index) {
 		Hash tid = block.header.transaction_hashes.at(tx_index);
 		bkey     = TRANSATION_PREFIX + DB::to_binary_key(tid.data, TRANSACTION_PREFIX_BYTES) +
 		       common::write_varint_sqlite4(info.height) + common::write_varint_sqlite4(tx_index + 1);
-		m_db.put(bkey, std::string(), true);
+		const auto &lo = locators.at(tx_index + 1);
+		m_db.put(bkey, common::write_varint_sqlite4(lo.first) + common::write_varint_sqlite4(lo.second), true);
 	}
 
 //	m_tip_segment.push_back(info);
@@ -506,18 +583,45 @@ void BlockChain::store_block(const Hash &bid, const BinaryArray &block_data) {
 }
 
 bool BlockChain::read_block(const Hash &bid, RawBlock &raw_block) const {
-	BinaryArray rb;
+	DB::Value rb;
+	platform::DBKey key(BLOCK_PREFIX);
+	key.append(bid.data, sizeof(bid.data)).append(BLOCK_SUFFIX);
+	if (!m_db.get(key.view(), rb))
+		return false;
+	seria::from_binary(raw_block, rb.data(), rb.size());
+	return true;
+}
+
+bool BlockChain::read_block(DB::Reader &reader, const Hash &bid, RawBlock &raw_block) {
+	DB::Reader::Value rb;
+	platform::DBKey key(BLOCK_PREFIX);
+	key.append(bid.data, sizeof(bid.data)).append(BLOCK_SUFFIX);
+	if (!reader.get(key.view(), rb))
+		return false;
+	seria::from_binary(raw_block, rb.data(), rb.size());
+	return true;
+}
+
+bool BlockChain::read_block_data(const Hash &bid, BinaryArray &block_data) const {
 	auto key = BLOCK_PREFIX + DB::to_binary_key(bid.data, sizeof(bid.data)) + BLOCK_SUFFIX;
-	if (!m_db.get(key, rb))
+	return m_db.get(key, block_data);
+}
+
+bool BlockChain::read_block_data(DB::Reader &reader, const Hash &bid, BinaryArray &block_data) {
+	DB::Reader::Value rb;
+	platform::DBKey key(BLOCK_PREFIX);
+	key.append(bid.data, sizeof(bid.data)).append(BLOCK_SUFFIX);
+	if (!reader.get(key.view(), rb))
 		return false;
-	seria::from_binary(raw_block, rb);
+	block_data.assign(rb.data(), rb.data() + rb.size());
 	return true;
 }
 
 bool BlockChain::has_block(const Hash &bid) const {
-	platform::DB::Value ms;
-	auto key = BLOCK_PREFIX + DB::to_binary_key(bid.data, sizeof(bid.data)) + BLOCK_SUFFIX;
-	if (!m_db.get(key, ms))
+	DB::Value ms;
+	platform::DBKey key(BLOCK_PREFIX);
+	key.append(bid.data, sizeof(bid.data)).append(BLOCK_SUFFIX);
+	if (!m_db.get(key.view(), ms))
 		return false;
 	return true;
 }
@@ -538,16 +642,42 @@ bool BlockChain::read_header(const Hash &bid, api::BlockHeader &header) const {
 //		header = m_tip_segment.back();
 //		return true;
 //	}
-	BinaryArray rb;
-	auto key = HEADER_PREFIX + DB::to_binary_key(bid.data, sizeof(bid.data)) + HEADER_SUFFIX;
-	if (!m_db.get(key, rb))
+	DB::Value rb;
+	platform::DBKey key(HEADER_PREFIX);
+	key.append(bid.data, sizeof(bid.data)).append(HEADER_SUFFIX);
+	if (!m_db.get(key.view(), rb))
 		return false;
 	Hash bbid = bid;
-	seria::from_binary(header, rb);
+	seria::from_binary(header, rb.data(), rb.size());
 	header_cache.insert(std::make_pair(bbid, header));
 	return true;
 }
 
+bool BlockChain::read_header(DB::Reader &reader, const Hash &bid, api::BlockHeader &header) {
+	DB::Reader::Value rb;
+	platform::DBKey key(HEADER_PREFIX);
+	key.append(bid.data, sizeof(bid.data)).append(HEADER_SUFFIX);
+	if (!reader.get(key.view(), rb))
+		return false;
+	seria::from_binary(header, rb.data(), rb.size());
+	return true;
+}
+
+void BlockChain::store_long_hash(const Hash &bid, const Hash &long_hash) {
+	auto key = BLOCK_PREFIX + DB::to_binary_key(bid.data, sizeof(bid.data)) + LONG_HASH_SUFFIX;
+	m_db.put(key, BinaryArray(std::begin(long_hash.data), std::end(long_hash.data)), false);
+}
+
+bool BlockChain::read_long_hash(const Hash &bid, Hash &long_hash) const {
+	DB::Value ba;
+	platform::DBKey key(BLOCK_PREFIX);
+	key.append(bid.data, sizeof(bid.data)).append(LONG_HASH_SUFFIX);
+	if (!m_db.get(key.view(), ba) || ba.size() != sizeof(long_hash.data))
+		return false;
+	std::copy(ba.data(), ba.data() + ba.size(), long_hash.data);
+	return true;
+}
+
 api::BlockHeader BlockChain::read_header(const Hash &bid) const {
 	api::BlockHeader result;
 	if (!read_header(bid, result))
@@ -571,8 +701,36 @@ const api::BlockHeader &BlockChain::get_tip() const {
 //	return m_tip_segment.back();
 }
 
-std::vector<api::BlockHeader>
-BlockChain::get_tip_segment(const api::BlockHeader & prev_info, Height window, bool add_genesis) const {
+static const size_t MIN_TIP_SEGMENT_SIZE = 1024;  // Larger than all consensus windows
+
+std::vector<api::BlockHeader> BlockChain::get_tip_segment(
+    const api::BlockHeader &prev_info, Height window, bool add_genesis) const {
+	std::vector<api::BlockHeader> result;
+	if (prev_info.height == Height(-1) || m_tip_height == Height(-1) || prev_info.height > m_tip_height)
+		return get_tip_segment_slow(prev_info, window, add_genesis);
+	// Heights [start..prev_info.height], genesis is included only if window is not filled without it
+	const Height start = prev_info.height + 1 > window ? prev_info.height + 1 - window : add_genesis ? 0 : 1;
+	if (start > prev_info.height)
+		return result;
+	if (m_tip_segment.empty())
+		m_tip_segment.push_back(read_header(get_tip_bid()));
+	while (m_tip_segment.front().height > start) {
+		Hash bid;
+		if (!read_chain(m_tip_segment.front().height - 1, bid))
+			throw std::logic_error("Invariant dead - main chain not found in get_tip_segment");
+		m_tip_segment.push_front(read_header(bid));
+	}
+	m_tip_segment_max_window = std::max<size_t>(m_tip_segment_max_window, prev_info.height + 1 - start);
+	const size_t prev_index  = prev_info.height - m_tip_segment.front().height;
+	if (m_tip_segment.at(prev_index).hash != prev_info.hash)  // Not on main chain
+		return get_tip_segment_slow(prev_info, window, add_genesis);
+	result.assign(m_tip_segment.begin() + (start - m_tip_segment.front().height),
+	    m_tip_segment.begin() + prev_index + 1);
+	return result;
+}
+
+std::vector<api::BlockHeader> BlockChain::get_tip_segment_slow(
+    const api::BlockHeader &prev_info, Height window, bool add_genesis) const {
 	std::vector<api::BlockHeader> result;
 	if( prev_info.height == Height(-1))
 		return result;
@@ -587,25 +745,15 @@ BlockChain::get_tip_segment(const api::BlockHeader & prev_info, Height window, b
 			throw std::logic_error("Invariant dead - window size not reached, but genesis not found in get_tip_segment");
 		result.push_back(pi);
 	}
-//	if (get_tip_height() == (Height)-1 || height_delta > get_tip_height())
-//		return std::make_pair(m_tip_segment.end(), m_tip_segment.end());
-//	while (m_tip_segment.size() < height_delta + window && m_tip_segment.size() < m_tip_height + 1) {
-//		Hash ha = read_chain(static_cast<uint32_t>(m_tip_height - m_tip_segment.size()));
-//		m_tip_segment.push_front(read_header(ha));
-//	}
-//	if (m_tip_height + 1 <= height_delta + window) {
-//			if( m_tip_segment.size() == m_tip_height + 1 ) {
-		//	if (height_delta + window >= m_tip_segment.size()) {
-//		return std::make_pair(m_tip_segment.begin() + (add_genesis ? 0 : 1), m_tip_segment.end() - height_delta);
-//	}
 	std::reverse(result.begin(), result.end());
-	return result;// std::make_pair(m_tip_segment.end() - window - height_delta, m_tip_segment.end() - height_delta);
+	return result;
 }
 
 void BlockChain::read_tip() {
-	DB::Cursor cur2 = m_db.rbegin(TIP_CHAIN_PREFIX + version_current + "/");
-	m_tip_height    = cur2.end() ? -1 : boost::lexical_cast<Height>(common::read_varint_sqlite4(cur2.get_suffix()));
-	seria::from_binary(m_tip_bid, cur2.get_value_array());
+	BinaryArray ba;
+	if (!m_db.get_last(m_chain_table, m_tip_height, ba))
+		m_tip_height = -1;
+	seria::from_binary(m_tip_bid, ba);
 	api::BlockHeader tip_block  = read_header(m_tip_bid);
 	m_tip_cumulative_difficulty = tip_block.cumulative_difficulty;
 }
@@ -613,24 +761,38 @@ void BlockChain::read_tip() {
 void BlockChain::push_chain(Hash bid, Difficulty cumulative_difficulty) {
 	m_tip_height += 1;
 	BinaryArray ba = seria::to_binary(bid);
-	m_db.put(TIP_CHAIN_PREFIX + version_current + "/" + common::write_varint_sqlite4(m_tip_height), ba, true);
+	m_db.put(m_chain_table, m_tip_height, ba, true);
 	m_tip_bid                   = bid;
 	m_tip_cumulative_difficulty = cumulative_difficulty;
+	if (!m_tip_segment.empty()) {
+		api::BlockHeader header = read_header(bid);
+		if (header.previous_block_hash != m_tip_segment.back().hash || header.height != m_tip_height)
+			m_tip_segment.clear();  // Should not happen, rebuilt on next get_tip_segment
+		else
+			m_tip_segment.push_back(header);
+		while (m_tip_segment.size() > std::max(MIN_TIP_SEGMENT_SIZE, m_tip_segment_max_window))
+			m_tip_segment.pop_front();
+	}
 	tip_changed();
 }
 
 void BlockChain::pop_chain() {
 	if (m_tip_height == 0)
 		throw std::logic_error("pop_chain tip_height == 0");
-	m_db.del(TIP_CHAIN_PREFIX + version_current + "/" + common::write_varint_sqlite4(m_tip_height), true);
+	m_db.del(m_chain_table, m_tip_height, true);
+	if (!m_tip_segment.empty() && m_tip_segment.back().height == m_tip_height)
+		m_tip_segment.pop_back();
+	else
+		m_tip_segment.clear();
 	m_tip_height -= 1;
+	m_committed_chain_size = std::min(m_committed_chain_size, m_tip_height + 1);
 }
 
 bool BlockChain::read_chain(uint32_t height, Hash &bid) const {
-	BinaryArray ba;
-	if (!m_db.get(TIP_CHAIN_PREFIX + version_current + "/" + common::write_varint_sqlite4(height), ba))
+	DB::Value ba;
+	if (!m_db.get(m_chain_table, height, ba))
 		return false;
-	seria::from_binary(bid, ba);
+	seria::from_binary(bid, ba.data(), ba.size());
 	return true;
 }
 
@@ -703,6 +865,8 @@ bool BlockChain::prune_branch(Difficulty cd, Hash bid) {
 	m_db.del(key, true);
 	auto key2 = HEADER_PREFIX + DB::to_binary_key(bid.data, sizeof(bid.data)) + HEADER_SUFFIX;
 	m_db.del(key2, true);
+	auto key3 = BLOCK_PREFIX + DB::to_binary_key(bid.data, sizeof(bid.data)) + LONG_HASH_SUFFIX;
+	m_db.del(key3, false);
 	return true;
 }
 
@@ -743,14 +907,24 @@ void BlockChain::test_print_structure() const {
 }
 
 bool BlockChain::read_next_internal_block(Hash &bid) const {
-	BinaryArray ba;
-	if (!m_db.get(
-	        TIP_CHAIN_PREFIX + previous_versions[0] + "/" + common::write_varint_sqlite4(get_tip_height() + 1), ba))
+	DB::Value ba;
+	if (!m_db.get(m_import_table, get_tip_height() + 1, ba))
 		return false;
-	seria::from_binary(bid, ba);
+	seria::from_binary(bid, ba.data(), ba.size());
 	return true;
 }
 
+size_t BlockChain::clear_table(DB::Table table) {
+	size_t erased = 0;
+	Height key    = 0;
+	BinaryArray ba;
+	while (m_db.get_last(table, key, ba)) {
+		m_db.del(table, key, true);
+		erased += 1;
+	}
+	return erased;
+}
+
 bool BlockChain::internal_import() {
 	auto idea_start = std::chrono::high_resolution_clock::now();
 	while (true) {
@@ -775,10 +949,7 @@ bool BlockChain::internal_import() {
 			return true;  // continue importing
 	}
 	std::cout << "Finished internal importing of blocks, clearing chains..." << std::endl;
-	size_t erased = 0;
-	for (DB::Cursor cur = m_db.begin(TIP_CHAIN_PREFIX + previous_versions[0] + "/"); !cur.end(); cur.erase()) {
-		erased += 1;
-	}
+	const size_t erased = clear_table(m_import_table);
 	std::cout << "Items erased " << erased << std::endl;
 	m_internal_import_known_height = 0;
 	db_commit();
@@ -44,15 +44,26 @@ public:
 	Height get_tip_height() const { return m_tip_height; }
 	const api::BlockHeader &get_tip() const;
 
-	std::vector<api::BlockHeader>
-	get_tip_segment(const api::BlockHeader & prev_info, Height window, bool add_genesis) const;
+	// Headers [prev_info.height - window + 1..prev_info.height], slice of main chain array if prev_info is on it
+	std::vector<api::BlockHeader> get_tip_segment(
+	    const api::BlockHeader &prev_info, Height window, bool add_genesis) const;
 
 	bool read_chain(Height height, Hash &bid) const;
 	bool read_block(const Hash &bid, RawBlock &rb) const;
+	bool read_block_data(const Hash &bid, BinaryArray &block_data) const;  // as stored, without decoding
 	bool has_block(const Hash &bid) const;
 	bool read_header(const Hash &bid, api::BlockHeader &info) const;
+	bool read_long_hash(const Hash &bid, Hash &long_hash) const;  // PoW hash, if block passed PoW check before
 	bool read_transaction(const Hash &tid, Transaction &tx, Height &height, size_t &index_in_block) const;
 
+	// Main chain heights below committed chain size are in DB snapshot, so worker threads can read them with
+	// DB::Reader created on get_db(). Static readers do not touch caches, so are safe to call from worker threads
+	Height get_committed_chain_size() const { return m_committed_chain_size; }
+	DB &get_db() { return m_db; }
+	static bool read_block(DB::Reader &reader, const Hash &bid, RawBlock &rb);
+	static bool read_block_data(DB::Reader &reader, const Hash &bid, BinaryArray &block_data);
+	static bool read_header(DB::Reader &reader, const Hash &bid, api::BlockHeader &info);
+
 	// Modify blockchain state. jetcash header does not contain enough info for consensus calcs, so we cannot have
 	// header chain without block chain
 	BroadcastAction add_block(const PreparedBlock &pb, api::BlockHeader &info);
@@ -69,15 +80,17 @@ public:
 	void test_undo_everything();
 	void test_print_structure() const;
 	void test_prune_oldest();
-	void db_commit();
+	virtual void db_commit();
 
 	bool internal_import();  // import some existing blocks from inside DB
 	Height internal_import_known_height() const { return m_internal_import_known_height; }
 
 protected:
 	bool read_next_internal_block(Hash &bid) const;
-	virtual bool check_standalone_consensus(
-	    const PreparedBlock &pb, api::BlockHeader &info, const api::BlockHeader &prev_info) const = 0;
+	size_t clear_table(DB::Table table);  // returns number of erased records
+	// long_hash is set if PoW hash was calculated, it is stored so that the same block is never hashed again
+	virtual bool check_standalone_consensus(const PreparedBlock &pb, api::BlockHeader &info,
+	    const api::BlockHeader &prev_info, Hash &long_hash) const = 0;
 	virtual bool redo_block(const Hash &bhash, const Block &block, const api::BlockHeader &info)  = 0;
 	virtual void undo_block(const Hash &bhash, const Block &block, Height height)                 = 0;
 	bool redo_block(const Hash &bhash, const RawBlock &raw_block, const Block &block, const api::BlockHeader &info,
@@ -91,6 +104,8 @@ protected:
 	    const Hash &bid1, const Hash &bid2, std::vector<Hash> *chain1, std::vector<Hash> *chain2) const;
 
 	DB m_db;
+	DB::Table m_chain_table;
+	DB::Table m_import_table;  // blocks are imported from DB in this order after version change
 
 	Hash read_chain(Height height) const;
 	api::BlockHeader read_header(const Hash &bid) const;
@@ -100,16 +115,22 @@ private:
 	Difficulty m_tip_cumulative_difficulty = 0;
 	Height m_tip_height                    = -1;
 	Height m_internal_import_known_height  = 0;
+	Height m_committed_chain_size          = 0;  // main chain [0..size) did not change since last commit
 	void read_tip();
 	void push_chain(Hash bid, Difficulty cumulative_difficulty);
 	void pop_chain();
 	mutable std::unordered_map<Hash, api::BlockHeader> header_cache;
 	// We cache recent headers for quick calculation in block windows
+	std::vector<api::BlockHeader> get_tip_segment_slow(
+	    const api::BlockHeader &prev_info, Height window, bool add_genesis) const;
+	mutable std::deque<api::BlockHeader> m_tip_segment;  // main chain headers ending at tip, survives db_commit
+	mutable size_t m_tip_segment_max_window = 0;          // we keep at least that many headers
 
 	void store_block(const Hash &bid, const BinaryArray &block_data);
 
 	// bid->header, header is stored in DB only if previous block is stored
 	void store_header(const Hash &bid, const api::BlockHeader &header);
+	void store_long_hash(const Hash &bid, const Hash &long_hash);
 
 	bool reorganize_blocks(
 	    const Hash &switch_to_chain, const PreparedBlock &recent_pb, const api::BlockHeader &recent_info);
@@ -3,6 +3,7 @@
 
 #include "BlockChainFileFormat.hpp"
 #include "BlockChainState.hpp"
+#include "common/string.hpp"
 #include "platform/PathTools.hpp"
 #include "seria/BinaryInputStream.hpp"
 #include "seria/BinaryOutputStream.hpp"
@@ -18,7 +19,10 @@ using namespace jetcash;
 //		std::cout << "Block tx count=" << pb.block.transactions.size() << std::endl;
 //	}
 
-LegacyBlockChainReader::LegacyBlockChainReader(const std::string &index_file_name, const std::string &item_file_name) {
+LegacyBlockChainReader::LegacyBlockChainReader(const std::string &index_file_name,
+    const std::string &item_file_name, size_t thread_count, size_t max_preload_size)
+    : thread_count(thread_count != 0 ? thread_count : std::max<size_t>(1, std::thread::hardware_concurrency()))
+    , max_preload_size(max_preload_size) {
 	try {
 		m_indexes_file = std::make_unique<platform::FileStream>(index_file_name, platform::FileStream::READ_EXISTING);
 		m_items_file   = std::make_unique<platform::FileStream>(item_file_name, platform::FileStream::READ_EXISTING);
@@ -40,7 +44,7 @@ LegacyBlockChainReader::~LegacyBlockChainReader() {
 		quit = true;
 		have_work.notify_all();
 	}
-	if (th.joinable())
+	for (auto &&th : threads)
 		th.join();
 }
 
@@ -73,8 +77,7 @@ BinaryArray LegacyBlockChainReader::get_block_data_by_index(Height i) {
 	return data_cache;
 }
 
-const size_t MAX_PRELOAD_BLOCKS     = 100;
-const size_t MAX_PRELOAD_TOTAL_SIZE = 50 * 1024 * 1024;
+const size_t MAX_PRELOAD_BLOCKS = 100;  // per thread
 
 void LegacyBlockChainReader::thread_run() {
 	while (true) {
@@ -83,19 +86,28 @@ void LegacyBlockChainReader::thread_run() {
 			std::unique_lock<std::mutex> lock(mu);
 			if (quit)
 				return;
-			if (next_load_height == 0)
-				next_load_height = last_load_height;
-			if (next_load_height > last_load_height + MAX_PRELOAD_BLOCKS ||
-			    total_prepared_data_size > MAX_PRELOAD_TOTAL_SIZE) {
+			if (next_load_height >= m_count || next_load_height > last_load_height + MAX_PRELOAD_BLOCKS * thread_count ||
+			    total_prepared_data_size > max_preload_size) {
 				have_work.wait(lock);
 				continue;
 			}
 			to_load = next_load_height++;
+			loading_heights.insert(to_load);
+		}
+		PreparedBlock pb;
+		try {
+			BinaryArray rba;
+			{
+				std::unique_lock<std::mutex> lock(file_mu);
+				rba = get_block_data_by_index(to_load);
+			}
+			pb = PreparedBlock(std::move(rba), nullptr);
+		} catch (const std::exception &) {  // empty block_data signals error to get_prepared_block_by_index
+			pb = PreparedBlock();
 		}
-		BinaryArray rba = get_block_data_by_index(to_load);
-		PreparedBlock pb(std::move(rba), nullptr);
 		{
 			std::unique_lock<std::mutex> lock(mu);
+			loading_heights.erase(to_load);
 			total_prepared_data_size += pb.block_data.size();
 			prepared_blocks[to_load] = std::move(pb);
 			prepared_blocks_ready.notify_all();
@@ -106,13 +118,31 @@ void LegacyBlockChainReader::thread_run() {
 static size_t max_ps = 0;
 PreparedBlock LegacyBlockChainReader::get_prepared_block_by_index(Height i) {
 	load_offsets();
+	bool read_now = false;
 	{
 		std::unique_lock<std::mutex> lock(mu);
-		if (!th.joinable())
-			th           = std::thread(&LegacyBlockChainReader::thread_run, this);
+		if (threads.empty())
+			for (size_t t = 0; t != thread_count; ++t)
+				threads.emplace_back(&LegacyBlockChainReader::thread_run, this);
+		if (i > next_load_height)  // Someone else imported blocks, skip them
+			next_load_height = i;
+		for (auto pit = prepared_blocks.begin(); pit != prepared_blocks.end() && pit->first < i;) {
+			total_prepared_data_size -= pit->second.block_data.size();
+			pit = prepared_blocks.erase(pit);
+		}
 		last_load_height = i;
+		// Block was already given out, happens when import_blocks is called again after add_block failed
+		read_now = i < next_load_height && prepared_blocks.count(i) == 0 && loading_heights.count(i) == 0;
 		have_work.notify_all();
 	}
+	if (read_now) {
+		BinaryArray rba;
+		{
+			std::unique_lock<std::mutex> lock(file_mu);
+			rba = get_block_data_by_index(i);
+		}
+		return PreparedBlock(std::move(rba), nullptr);
+	}
 	while (true) {
 		std::unique_lock<std::mutex> lock(mu);
 		auto pit = prepared_blocks.find(i);
@@ -124,6 +154,9 @@ PreparedBlock LegacyBlockChainReader::get_prepared_block_by_index(Height i) {
 		pit                  = prepared_blocks.erase(pit);
 		max_ps               = std::max(max_ps, total_prepared_data_size);
 		total_prepared_data_size -= result.block_data.size();
+		have_work.notify_all();
+		if (result.block_data.empty())
+			throw std::runtime_error("Failed to read or parse block " + common::to_string(i));
 		return result;
 	}
 }
@@ -133,8 +166,7 @@ bool LegacyBlockChainReader::import_blocks(BlockChainState &block_chain) {
 		auto idea_start = std::chrono::high_resolution_clock::now();
 		// size_t bs_count = std::min(block_chain.get_tip_height() + 1 + count, get_block_count());
 		while (block_chain.get_tip_height() + 1 < get_block_count()) {
-			BinaryArray rba = get_block_data_by_index(block_chain.get_tip_height() + 1);
-			PreparedBlock pb(std::move(rba), nullptr);
+			PreparedBlock pb = get_prepared_block_by_index(block_chain.get_tip_height() + 1);
 			api::BlockHeader info;
 			if (block_chain.add_block(pb, info) != BroadcastAction::BROADCAST_ALL) {
 				std::cout << "block_chain.add_block !BROADCAST_ALL block=" << block_chain.get_tip_height() + 1
@@ -157,7 +189,8 @@ bool LegacyBlockChainReader::import_blocks(BlockChainState &block_chain) {
 	return block_chain.get_tip_height() + 1 < get_block_count();  // Not finished
 }
 
-bool LegacyBlockChainReader::import_blockchain2(const std::string &coin_folder, BlockChainState &block_chain) {
+bool LegacyBlockChainReader::import_blockchain2(
+    const std::string &coin_folder, BlockChainState &block_chain, size_t thread_count) {
 	//	std::fstream ts_file("/Users/user/jetcash/timestamps.txt",
 	// std::ios::out | std::ios::trunc);
 	//	ts_file << "Block timestamp\tBlock median_timestamp\tBlock
@@ -165,7 +198,7 @@ bool LegacyBlockChainReader::import_blockchain2(const std::string &coin_folder,
 	//	           "difference\tMedian - Timestamp"
 	//	        << std::endl;
 
-	LegacyBlockChainReader reader(coin_folder + "/blockindexes.bin", coin_folder + "/blocks.bin");
+	LegacyBlockChainReader reader(coin_folder + "/blockindexes.bin", coin_folder + "/blocks.bin", thread_count);
 	const size_t bs_count = reader.get_block_count();
 	if (block_chain.get_tip_height() > bs_count) {
 		std::cout << "Skipping block chain import - we have more blocks than "
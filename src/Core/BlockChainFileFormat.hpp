@@ -5,6 +5,7 @@
 
 #include <condition_variable>
 #include <cstdint>
+#include <set>
 #include <string>
 #include <thread>
 #include <vector>
@@ -23,21 +24,27 @@ class LegacyBlockChainReader {
 	std::vector<uint64_t> m_offsets;  // we artifically add offset of the end of file
 	void load_offsets();
 
-	std::thread th;
+	std::vector<std::thread> threads;
+	std::mutex file_mu;  // m_items_file is read by all preparator threads
 	std::mutex mu;
 	std::condition_variable have_work;
 	std::condition_variable prepared_blocks_ready;
 	bool quit = false;
 
-	std::map<Height, PreparedBlock> prepared_blocks;
+	size_t thread_count;
+	size_t max_preload_size;                          // total size of blocks waiting in prepared_blocks
+	std::map<Height, PreparedBlock> prepared_blocks;  // threads finish out of order, we give out in order
+	std::set<Height> loading_heights;                 // taken by threads, but not yet in prepared_blocks
 	size_t total_prepared_data_size = 0;
 	Height last_load_height         = 0;
 	Height next_load_height         = 0;
 	void thread_run();
 
 public:
-	// No exceptions, just return block count 0
-	explicit LegacyBlockChainReader(const std::string &index_file_name, const std::string &item_file_name);
+	enum { DEFAULT_MAX_PRELOAD_SIZE = 50 * 1024 * 1024 };
+	// No exceptions, just return block count 0. thread_count 0 means all cores
+	explicit LegacyBlockChainReader(const std::string &index_file_name, const std::string &item_file_name,
+	    size_t thread_count = 0, size_t max_preload_size = DEFAULT_MAX_PRELOAD_SIZE);
 	~LegacyBlockChainReader();
 	Height get_block_count() const { return m_count; }
 	BinaryArray get_block_data_by_index(Height);
@@ -45,7 +52,8 @@ public:
 
 	bool import_blocks(BlockChainState &block_chain);  // return false when no more blocks remain
 
-	static bool import_blockchain2(const std::string &coin_folder, BlockChainState &block_chain);
+	static bool import_blockchain2(
+	    const std::string &coin_folder, BlockChainState &block_chain, size_t thread_count = 0);
 };
 
 class LegacyBlockChainWriter {
@@ -18,6 +18,8 @@ static const std::string AMOUNT_OUTPUT_PREFIX        = "a";
 static const std::string BLOCK_GLOBAL_INDICES_PREFIX = "b";
 static const std::string BLOCK_GLOBAL_INDICES_SUFFIX = "g";
 static const std::string FIRST_SEEN_PREFIX           = "f";
+static const std::string KEYIMAGE_FILTER_KEY         = "$keyimage_filter";
+static const std::string KEYIMAGE_FILTER_CHUNK_PREFIX = "$keyimage_filter/";
 
 const bool create_unlock_index               = false;
 static const std::string UNLOCK_BLOCK_PREFIX = "u";
@@ -42,6 +44,73 @@ static size_t get_complexity(const Transaction &tx) {  // For pool
 	return result;
 }
 
+namespace seria {
+void ser_members(KeyImageFilter &v, ISeria &s) {  // bits are stored separately by chunks
+	seria_kv("tip_bid", v.tip_bid, s);
+	seria_kv("count", v.count, s);
+	uint64_t size = v.bits.size();
+	seria_kv("size", size, s);
+	if (s.is_input())
+		v.bits.resize(size);
+}
+}  // namespace seria
+
+KeyImageFilter::KeyImageFilter(size_t capacity) {
+	size_t bit_count = 8;
+	while (bit_count < std::max<size_t>(capacity, MIN_CAPACITY) * BITS_PER_ITEM)
+		bit_count *= 2;  // power of 2, so that we can mask hash values
+	bits.resize(bit_count / 8);
+}
+
+void KeyImageFilter::insert(const KeyImage &keyimage) {
+	const size_t mask = bits.size() * 8 - 1;
+	for (size_t i = 0; i != HASH_COUNT; ++i) {
+		uint32_t h = 0;
+		memcpy(&h, keyimage.data + i * sizeof(h), sizeof(h));
+		h &= mask;
+		bits[h / 8] |= 1U << (h % 8);
+		changed_chunks.insert(h / 8 / CHUNK_SIZE);
+	}
+	count += 1;
+}
+
+bool KeyImageFilter::may_contain(const KeyImage &keyimage) const {
+	const size_t mask = bits.size() * 8 - 1;
+	for (size_t i = 0; i != HASH_COUNT; ++i) {
+		uint32_t h = 0;
+		memcpy(&h, keyimage.data + i * sizeof(h), sizeof(h));
+		h &= mask;
+		if ((bits[h / 8] & (1U << (h % 8))) == 0)
+			return false;
+	}
+	return true;
+}
+
+Hash RingSignatureCache::get_key(const Hash &tx_prefix_hash, const KeyImage &keyimage,
+    const std::vector<PublicKey> &output_keys, const std::vector<Signature> &signatures) {
+	BinaryArray ba;
+	ba.reserve(sizeof(Hash) + sizeof(KeyImage) + output_keys.size() * sizeof(PublicKey) +
+	           signatures.size() * sizeof(Signature));
+	common::append(ba, std::begin(tx_prefix_hash.data), std::end(tx_prefix_hash.data));
+	common::append(ba, std::begin(keyimage.data), std::end(keyimage.data));
+	for (auto &&key : output_keys)
+		common::append(ba, std::begin(key.data), std::end(key.data));
+	for (auto &&sig : signatures)
+		common::append(ba, reinterpret_cast<const unsigned char *>(&sig),
+		    reinterpret_cast<const unsigned char *>(&sig) + sizeof(sig));
+	return crypto::cn_fast_hash(ba.data(), ba.size());
+}
+
+void RingSignatureCache::insert(const Hash &key) {
+	if (!m_keys.insert(key).second)
+		return;
+	m_order.push_back(key);
+	if (m_order.size() > MAX_SIZE) {
+		m_keys.erase(m_order.front());
+		m_order.pop_front();
+	}
+}
+
 void BlockChainState::DeltaState::store_keyimage(const KeyImage &keyimage, Height height) {
 	if (!m_keyimages.insert(std::make_pair(keyimage, height)).second)
 		throw std::logic_error("store_keyimage already exists. Invariant dead");
@@ -130,6 +199,8 @@ BlockChainState::BlockChainState(logging::ILogger &log, const Config &config, co
     , m_log(log, "BlockChainState")
     , m_memory_state_total_complexity(0)
     , log_redo_block_timestamp(std::chrono::steady_clock::now()) {
+	m_db.set_background_sync(config.db_background_sync);
+	load_keyimage_filter();
 	if (get_tip_height() == (Height)-1) {
 		Block genesis_block;
 		genesis_block.header = currency.genesis_block_template;
@@ -145,14 +216,14 @@ BlockChainState::BlockChainState(logging::ILogger &log, const Config &config, co
 	BlockChainState::tip_changed();
 }
 
-bool BlockChainState::check_standalone_consensus(
-    const PreparedBlock &pb, api::BlockHeader &info, const api::BlockHeader &prev_info) const {
-	auto err = get_standalone_consensus_error(pb, info, prev_info);
+bool BlockChainState::check_standalone_consensus(const PreparedBlock &pb, api::BlockHeader &info,
+    const api::BlockHeader &prev_info, Hash &long_hash) const {
+	auto err = get_standalone_consensus_error(pb, info, prev_info, long_hash);
 	return err.empty();
 }
 
-std::string BlockChainState::get_standalone_consensus_error(
-    const PreparedBlock &pb, api::BlockHeader &info, const api::BlockHeader &prev_info) const {
+std::string BlockChainState::get_standalone_consensus_error(const PreparedBlock &pb, api::BlockHeader &info,
+    const api::BlockHeader &prev_info, Hash &long_hash) const {
 	const auto &block = pb.block;
 	if (block.transactions.size() != block.header.transaction_hashes.size())
 		return "WRONG_TRANSACTIONS_COUNT";
@@ -279,10 +350,15 @@ std::string BlockChainState::get_standalone_consensus_error(
 		if (!m_currency.check_block_checkpoint(info.height, info.hash, is_checkpoint))
 			return "CHECKPOINT_BLOCK_HASH_MISMATCH";
 	} else {
-		Hash long_hash = pb.long_block_hash != Hash{} ? pb.long_block_hash
-		                                              : get_block_long_hash(block.header, m_hash_crypto_context);
-		if (!m_currency.check_proof_of_work(long_hash, block.header, info.difficulty))
+		Hash pow_hash;
+		const bool stored = read_long_hash(info.hash, pow_hash);  // reorgs and reimports of known blocks
+		if (!stored)
+			pow_hash = pb.long_block_hash != Hash{} ? pb.long_block_hash
+			                                        : get_block_long_hash(block.header, m_hash_crypto_context);
+		if (!m_currency.check_proof_of_work(pow_hash, block.header, info.difficulty))
 			return "PROOF_OF_WORK_TOO_WEAK";
+		if (!stored)
+			long_hash = pow_hash;
 	}
 	return std::string();
 }
@@ -319,25 +395,103 @@ void BlockChainState::calculate_consensus_values(const api::BlockHeader & prev_i
 
 void BlockChainState::tip_changed() {
 	calculate_consensus_values(read_header(get_tip_bid()), m_next_median_size, m_next_median_timestamp, m_next_unlock_timestamp);
+	m_mining_template.valid = false;
 }
 
-bool BlockChainState::create_mining_block_template(BlockTemplate &b, const AccountPublicAddress &adr,
-    const BinaryArray &extra_nonce, Difficulty &difficulty, Height &height) const {
-	clear_mining_transactions();
-	height = get_tip_height() + 1;
+void BlockChainState::rebuild_mining_template() const {
+	const Height height = get_tip_height() + 1;
+	MiningTemplate &mt  = m_mining_template;
+	mt                  = MiningTemplate{};
+	mt.tip_bid          = get_tip_bid();
 	{
 		std::vector<Timestamp> timestamps;
 		std::vector<Difficulty> difficulties;
 		Height blocks_count = std::min(get_tip_height(), m_currency.difficulty_blocks_count());
 		timestamps.reserve(blocks_count);
 		difficulties.reserve(blocks_count);
-		auto timestamps_window = get_tip_segment(read_header(get_tip_bid()), blocks_count, false);
+		auto timestamps_window = get_tip_segment(get_tip(), blocks_count, false);
 		for (auto it = timestamps_window.begin(); it != timestamps_window.end(); ++it) {
 			timestamps.push_back(it->timestamp);
 			difficulties.push_back(it->cumulative_difficulty);
 		}
-		difficulty = m_currency.next_difficulty(timestamps, difficulties);
+		mt.difficulty = m_currency.next_difficulty(timestamps, difficulties);
 	}
+	const uint8_t major_version = m_currency.get_block_major_version_for_height(height);
+	auto next_block_granted_full_reward_zone =
+	    m_currency.block_granted_full_reward_zone_by_block_version(major_version);
+	auto effective_size_median = std::max(m_next_median_size, next_block_granted_full_reward_zone);
+	auto max_total_size        = (125 * effective_size_median) / 100;
+	auto max_cumulative_size   = m_currency.max_block_cumulative_size(height);
+	mt.max_txs_size = std::min(max_total_size, max_cumulative_size) - m_currency.miner_tx_blob_reserved_size;
+
+	std::vector<Hash> pool_hashes;
+	for (auto &&msf : m_memory_state_fee_tx)
+		for (auto &&ha : msf.second)
+			pool_hashes.push_back(ha);
+	const Timestamp timestamp = std::max(static_cast<Timestamp>(time(nullptr)), m_next_median_timestamp);
+	mt.memory_state.reset(new DeltaState(height, timestamp, this));
+	// will be get_tip().timestamp_unlock after fork
+	// technically we should give unlock timestamp of next block, but more
+	// conservative also works
+	mt.valid = true;
+
+	for (; !pool_hashes.empty(); pool_hashes.pop_back()) {
+		auto tit = m_memory_state_tx.find(pool_hashes.back());
+		if (tit == m_memory_state_tx.end()) {
+			m_log(logging::ERROR) << "Transaction " << common::pod_to_hex(pool_hashes.back())
+			                      << " is in pool index, but not in pool";
+			assert(false);
+			continue;
+		}
+		const size_t tx_size = tit->second.binary_size;
+		if (mt.txs_size + tx_size > mt.max_txs_size)
+			continue;
+		Amount single_fee = 0;
+		bool fatal        = false;
+		BlockGlobalIndices global_indices;
+		std::string result = redo_transaction_get_error(  // signatures were checked when added to pool
+		    false, tit->second.tx, mt.memory_state.get(), global_indices, false, single_fee, fatal);
+		if (!result.empty()) {
+			m_log(logging::ERROR) << "Transaction " << common::pod_to_hex(tit->first)
+			                      << " is in pool, but could not be redone result=" << result << std::endl;
+			continue;
+		}
+		mt.txs_size += tx_size;
+		mt.fee += single_fee;
+		mt.transaction_hashes.emplace_back(tit->first);
+	}
+}
+
+void BlockChainState::add_to_mining_template(const Hash &tid, const PoolTransaction &ptx) {
+	MiningTemplate &mt = m_mining_template;
+	if (!mt.valid || mt.tip_bid != get_tip_bid())
+		return;
+	const size_t tx_size = ptx.binary_size;
+	if (mt.txs_size + tx_size > mt.max_txs_size) {
+		mt.valid = false;  // Full block, rebuild will select by fee
+		return;
+	}
+	Amount single_fee = 0;
+	bool fatal        = false;
+	BlockGlobalIndices global_indices;
+	std::string result =  // signatures were checked when added to pool
+	    redo_transaction_get_error(false, ptx.tx, mt.memory_state.get(), global_indices, false, single_fee, fatal);
+	if (!result.empty()) {
+		mt.valid = false;  // Conflicts with transaction already in template
+		return;
+	}
+	mt.txs_size += tx_size;
+	mt.fee += single_fee;
+	mt.transaction_hashes.emplace_back(tid);
+}
+
+bool BlockChainState::create_mining_block_template(BlockTemplate &b, const AccountPublicAddress &adr,
+    const BinaryArray &extra_nonce, Difficulty &difficulty, Height &height) const {
+	clear_mining_transactions();
+	height = get_tip_height() + 1;
+	if (!m_mining_template.valid || m_mining_template.tip_bid != get_tip_bid())
+		rebuild_mining_template();
+	difficulty = m_mining_template.difficulty;
 	if (difficulty == 0) {
 		//    log(Logging::ERROR, Logging::BrightRed) << "difficulty overhead.";
 		return false;
@@ -375,48 +529,17 @@ bool BlockChainState::create_mining_block_template(BlockTemplate &b, const Accou
 	auto effective_size_median     = std::max(m_next_median_size, next_block_granted_full_reward_zone);
 	Amount already_generated_coins = get_tip().already_generated_coins;
 
-	auto max_total_size      = (125 * effective_size_median) / 100;
-	auto max_cumulative_size = m_currency.max_block_cumulative_size(height);
-	max_total_size           = std::min(max_total_size, max_cumulative_size) - m_currency.miner_tx_blob_reserved_size;
-
-	std::vector<Hash> pool_hashes;
-	for (auto &&msf : m_memory_state_fee_tx)
-		for (auto &&ha : msf.second)
-			pool_hashes.push_back(ha);
-	size_t txs_size = 0;
-	Amount fee      = 0;
-	DeltaState memory_state(height, b.timestamp, this);  // will be get_tip().timestamp_unlock after fork
-	// technically we should give unlock timestamp of next block, but more
-	// conservative also works
-
-	for (; !pool_hashes.empty(); pool_hashes.pop_back()) {
-		auto tit = m_memory_state_tx.find(pool_hashes.back());
-		if (tit == m_memory_state_tx.end()) {
-			m_log(logging::ERROR) << "Transaction " << common::pod_to_hex(pool_hashes.back())
-			                      << " is in pool index, but not in pool";
-			assert(false);
+	const size_t txs_size = m_mining_template.txs_size;
+	const Amount fee      = m_mining_template.fee;
+	b.transaction_hashes  = m_mining_template.transaction_hashes;
+	for (auto &&tid : b.transaction_hashes) {
+		auto mit = m_mining_transactions.find(tid);
+		if (mit != m_mining_transactions.end()) {
+			mit->second.second = height;
 			continue;
 		}
-		size_t block_size_limit = max_total_size;
-		size_t tx_size          = seria::binary_size(tit->second);  // TODO - remember size in tx index
-		if (txs_size + tx_size > block_size_limit)
-			continue;
-		Amount single_fee = 0;
-		bool fatal        = false;
-		BlockGlobalIndices global_indices;
-		std::string result =
-		    redo_transaction_get_error(false, tit->second, &memory_state, global_indices, true, single_fee,
-		        fatal);  // next_median_timestamp
-		if (!result.empty()) {
-			m_log(logging::ERROR) << "Transaction " << common::pod_to_hex(tit->first)
-			                      << " is in pool, but could not be redone result=" << result << std::endl;
-			continue;
-		}
-		txs_size += tx_size;
-		fee += single_fee;
-		b.transaction_hashes.emplace_back(tit->first);
-		m_mining_transactions.insert(std::make_pair(tit->first, std::make_pair(tit->second, height)));
-		m_log(logging::TRACE) << "Transaction " << common::pod_to_hex(tit->first) << " included to block template";
+		m_mining_transactions.insert(std::make_pair(tid, std::make_pair(m_memory_state_tx.at(tid).tx, height)));
+		m_log(logging::TRACE) << "Transaction " << common::pod_to_hex(tid) << " included to block template";
 	}
 
 	// two-phase miner transaction generation: we don't know exact block size
@@ -514,7 +637,7 @@ BroadcastAction BlockChainState::add_mined_block(
 		auto tit              = m_memory_state_tx.find(tx_hash);
 		const Transaction *tx = nullptr;
 		if (tit != m_memory_state_tx.end())
-			tx = &(tit->second);
+			tx = &(tit->second.tx);
 		else {
 			auto tit2 = m_mining_transactions.find(tx_hash);
 			if (tit2 == m_mining_transactions.end()) {
@@ -596,6 +719,9 @@ static std::string validate_semantic(bool generating, const Transaction &tx, uin
 	return std::string();
 }
 
+BlockChainState::PoolTransaction::PoolTransaction(const Transaction &tx, size_t binary_size, Amount fee)
+    : tx(tx), binary_size(binary_size), fee(fee), fee_per_byte(fee / binary_size) {}
+
 BroadcastAction BlockChainState::add_transaction(const Transaction &tx, Timestamp now) {
 	auto thash            = get_transaction_hash(tx);
 	Timestamp g_timestamp = read_first_seen_timestamp(thash);
@@ -606,7 +732,6 @@ BroadcastAction BlockChainState::add_transaction(const Transaction &tx, Timestam
 
 BroadcastAction BlockChainState::add_transaction(const Hash &tid, const Transaction &tx, Height unlock_height,
     Timestamp unlock_timestamp, size_t max_pool_complexity, bool check_sigs) {
-	const size_t my_size = seria::binary_size(tx);
 	if (m_memory_state_tx.count(tid) != 0)
 		return BroadcastAction::NOTHING;
 	DeltaState memory_state(unlock_height, unlock_timestamp, this);  // timestamp_unlock after fork
@@ -622,18 +747,15 @@ BroadcastAction BlockChainState::add_transaction(const Hash &tid, const Transact
 	// Only good transactions are recorded in tx_first_seen, because they require
 	// space there
 	update_first_seen_timestamp(tid, unlock_timestamp);
-	const Amount my_fee_per_coin = my_fee / my_size;
+	PoolTransaction ptx(tx, seria::binary_size(tx), my_fee);
 	for (auto &&ki : memory_state.get_keyimages()) {
 		auto tit = m_memory_state_ki_tx.find(ki.first);
 		if (tit == m_memory_state_ki_tx.end())
 			continue;
-		const Transaction &other_tx     = m_memory_state_tx.at(tit->second);
-		const Amount other_fee          = jetcash::get_tx_fee(other_tx);  // TODO - optimize get fee
-		const size_t other_size         = seria::binary_size(other_tx);
-		const Amount other_fee_per_coin = other_fee / other_size;
-		if (my_fee_per_coin < other_fee_per_coin)
+		const Amount other_fee_per_byte = m_memory_state_tx.at(tit->second).fee_per_byte;
+		if (ptx.fee_per_byte < other_fee_per_byte)
 			return BroadcastAction::NOTHING;
-		if (my_fee_per_coin == other_fee_per_coin &&
+		if (ptx.fee_per_byte == other_fee_per_byte &&
 		    tid < tit->second)  // Deterministic behaviour so tx pools have tendency
 			                    // to stay the same
 			return BroadcastAction::NOTHING;
@@ -645,9 +767,9 @@ BroadcastAction BlockChainState::add_transaction(const Hash &tid, const Transact
 		if (!m_memory_state_ki_tx.insert(std::make_pair(ki.first, tid)).second)
 			all_inserted = false;
 	}
-	if (!m_memory_state_tx.insert(std::make_pair(tid, tx)).second)
+	if (!m_memory_state_fee_tx[ptx.fee_per_byte].insert(tid).second)
 		all_inserted = false;
-	if (!m_memory_state_fee_tx[my_fee_per_coin].insert(tid).second)
+	if (!m_memory_state_tx.insert(std::make_pair(tid, std::move(ptx))).second)
 		all_inserted = false;
 	if (!all_inserted)  // insert all before throw
 		throw std::logic_error("Invariant dead, memory_state_fee_tx empty");
@@ -664,6 +786,9 @@ BroadcastAction BlockChainState::add_transaction(const Hash &tid, const Transact
 		remove_from_pool(rhash);
 	}
 	m_tx_pool_version += 1;
+	auto tit = m_memory_state_tx.find(tid);
+	if (tit != m_memory_state_tx.end())
+		add_to_mining_template(tid, tit->second);
 	return BroadcastAction::BROADCAST_ALL;
 }
 
@@ -672,7 +797,7 @@ void BlockChainState::remove_from_pool(Hash tid) {
 	if (tit == m_memory_state_tx.end())
 		return;
 	bool all_erased       = true;
-	const Transaction &tx = tit->second;
+	const Transaction &tx = tit->second.tx;
 	for (const auto &input : tx.inputs) {
 		if (input.type() == typeid(KeyInput)) {
 			const KeyInput &in = boost::get<KeyInput>(input);
@@ -680,15 +805,14 @@ void BlockChainState::remove_from_pool(Hash tid) {
 				all_erased = false;
 		}
 	}
-	const Amount my_fee          = jetcash::get_tx_fee(tx);  // TODO - optimize get fee
-	const size_t my_size         = seria::binary_size(tx);
-	const Amount my_fee_per_coin = my_fee / my_size;
-	if (m_memory_state_fee_tx[my_fee_per_coin].erase(tid) != 1)
+	const Amount fee_per_byte = tit->second.fee_per_byte;
+	if (m_memory_state_fee_tx[fee_per_byte].erase(tid) != 1)
 		all_erased = false;
-	if (m_memory_state_fee_tx[my_fee_per_coin].empty())
-		m_memory_state_fee_tx.erase(my_fee_per_coin);
+	if (m_memory_state_fee_tx[fee_per_byte].empty())
+		m_memory_state_fee_tx.erase(fee_per_byte);
 	m_memory_state_total_complexity -= get_complexity(tx);
 	m_memory_state_tx.erase(tit);
+	m_mining_template.valid = false;
 	if (!all_erased)
 		throw std::logic_error("Invariant dead, remove_memory_pool failed to erase everything");
 	// We do not increment m_tx_pool_version, because removing tx from pool is
@@ -697,10 +821,11 @@ void BlockChainState::remove_from_pool(Hash tid) {
 
 Timestamp BlockChainState::read_first_seen_timestamp(const Hash &tid) const {
 	Timestamp ta = 0;
-	auto key     = FIRST_SEEN_PREFIX + DB::to_binary_key(tid.data, sizeof(tid.data));
-	BinaryArray ba;
-	if (m_db.get(key, ba))
-		seria::from_binary(ta, ba);
+	platform::DBKey key(FIRST_SEEN_PREFIX);
+	key.append(tid.data, sizeof(tid.data));
+	DB::Value ba;
+	if (m_db.get(key.view(), ba))
+		seria::from_binary(ta, ba.data(), ba.size());
 	return ta;
 }
 
@@ -732,9 +857,11 @@ RingCheckerMulticore::~RingCheckerMulticore() {
 		th.join();
 }
 
+const size_t MAX_RING_CHECK_CHUNK = 16;
+
 void RingCheckerMulticore::thread_run() {
 	while (true) {
-		RingSignatureArg arg;
+		std::vector<RingSignatureArg> chunk;
 		int local_work_counter = 0;
 		{
 			std::unique_lock<std::mutex> lock(mu);
@@ -745,24 +872,38 @@ void RingCheckerMulticore::thread_run() {
 				continue;
 			}
 			local_work_counter = work_counter;
-			arg                = std::move(args.front());
-			args.pop_front();
+			// Leave work for other threads if there is not much of it
+			const size_t chunk_size = std::max<size_t>(1, std::min(MAX_RING_CHECK_CHUNK, args.size() / threads.size()));
+			chunk.reserve(chunk_size);
+			for (size_t i = 0; i != chunk_size; ++i) {
+				chunk.push_back(std::move(args.front()));
+				args.pop_front();
+			}
+		}
+		std::vector<std::vector<const PublicKey *>> output_key_pointers(chunk.size());
+		std::vector<crypto::RingSignatureCheck> checks(chunk.size());
+		for (size_t i = 0; i != chunk.size(); ++i) {
+			const RingSignatureArg &arg = chunk[i];
+			output_key_pointers[i].reserve(arg.output_keys.size());
+			for (const auto &key : arg.output_keys)
+				output_key_pointers[i].push_back(&key);
+			checks[i].prefix_hash = arg.tx_prefix_hash;
+			checks[i].image       = arg.key_image;
+			checks[i].pubs        = output_key_pointers[i].data();
+			checks[i].pubs_count  = output_key_pointers[i].size();
+			checks[i].sigs        = arg.signatures.data();
 		}
-		std::vector<const PublicKey *> output_key_pointers;
-		output_key_pointers.reserve(arg.output_keys.size());
-		std::for_each(arg.output_keys.begin(), arg.output_keys.end(),
-		    [&output_key_pointers](const PublicKey &key) { output_key_pointers.push_back(&key); });
-		bool key_corrupted = false;
-		bool result        = check_ring_signature(arg.tx_prefix_hash, arg.key_image, output_key_pointers.data(),
-		    output_key_pointers.size(), arg.signatures.data(), true, &key_corrupted);
+		crypto::check_ring_signatures(checks.data(), checks.size(), true);
 		{
 			std::unique_lock<std::mutex> lock(mu);
 			if (local_work_counter == work_counter) {
-				ready_counter += 1;
-				if (!result && key_corrupted)  // TODO - db corrupted
-					errors.push_back("INPUT_CORRUPTED_SIGNATURES");
-				if (!result && !key_corrupted)
-					errors.push_back("INPUT_INVALID_SIGNATURES");
+				ready_counter += chunk.size();
+				for (const auto &check : checks) {
+					if (!check.result && check.key_corrupted)  // TODO - db corrupted
+						errors.push_back("INPUT_CORRUPTED_SIGNATURES");
+					if (!check.result && !check.key_corrupted)
+						errors.push_back("INPUT_INVALID_SIGNATURES");
+				}
 				result_ready.notify_all();
 			}
 		}
@@ -775,7 +916,7 @@ void RingCheckerMulticore::cancel_work() {
 }
 
 std::string RingCheckerMulticore::start_work_get_error(IBlockChainState *state, const Currency &currency,
-    const Block &block, Height unlock_height, Timestamp unlock_timestamp) {
+    const Block &block, Height unlock_height, Timestamp unlock_timestamp, const RingSignatureCache *cache) {
 	{
 		std::unique_lock<std::mutex> lock(mu);
 		args.clear();
@@ -813,6 +954,11 @@ std::string RingCheckerMulticore::start_work_get_error(IBlockChainState *state,
 					if (!currency.is_transaction_spend_time_unlocked(unlock_time, unlock_height, unlock_timestamp))
 						return "INPUT_SPEND_LOCKED_OUT";
 				}
+				if (cache && cache->contains(RingSignatureCache::get_key(
+				                 arg.tx_prefix_hash, arg.key_image, arg.output_keys, arg.signatures))) {
+					input_index++;
+					continue;
+				}
 				// As soon as first arg is ready, other thread can start work while we
 				// continue reading from slow DB
 				total_counter += 1;
@@ -883,12 +1029,19 @@ std::string BlockChainState::redo_transaction_get_error(bool generating, const T
 				std::for_each(output_keys.begin(), output_keys.end(),
 				    [&output_key_pointers](const PublicKey &key) { output_key_pointers.push_back(&key); });
 				bool key_corrupted = false;
-				if (check_sigs &&
-				    !check_ring_signature(tx_prefix_hash, in.key_image, output_key_pointers.data(),
-				        output_key_pointers.size(), transaction.signatures[input_index].data(), true, &key_corrupted)) {
-					if (key_corrupted)  // TODO - db corrupted
-						return "INPUT_CORRUPTED_SIGNATURES";
-					return "INPUT_INVALID_SIGNATURES";
+				const Hash cache_key =
+				    check_sigs ? RingSignatureCache::get_key(
+				                     tx_prefix_hash, in.key_image, output_keys, transaction.signatures[input_index])
+				               : Hash{};
+				if (check_sigs && !m_ring_signature_cache.contains(cache_key)) {
+					if (!check_ring_signature(tx_prefix_hash, in.key_image, output_key_pointers.data(),
+					        output_key_pointers.size(), transaction.signatures[input_index].data(), true,
+					        &key_corrupted)) {
+						if (key_corrupted)  // TODO - db corrupted
+							return "INPUT_CORRUPTED_SIGNATURES";
+						return "INPUT_INVALID_SIGNATURES";
+					}
+					m_ring_signature_cache.insert(cache_key);
 				}
 			}
 			tx_delta.store_keyimage(in.key_image, delta_state->get_block_height());
@@ -950,7 +1103,8 @@ bool BlockChainState::redo_block(const Hash &bhash, const Block &block, const ap
 	BlockGlobalIndices global_indices;
 	global_indices.reserve(block.transactions.size() + 1);
 	const bool check_sigs = !m_currency.is_in_checkpoint_zone(info.height + 1);
-	if (check_sigs && !ring_checker.start_work_get_error(this, m_currency, block, info.height, info.timestamp).empty())
+	if (check_sigs && !ring_checker.start_work_get_error(this, m_currency, block, info.height, info.timestamp,
+	                                                         &m_ring_signature_cache).empty())
 		return false;
 	if (!redo_block(block, info, &delta, global_indices))
 		return false;
@@ -993,13 +1147,12 @@ void BlockChainState::undo_block(const Hash &bhash, const Block &block, Height h
 	m_db.del(key, true);
 
 	// Now put transactions to pool
-	for (auto tit = block.transactions.begin(); tit != block.transactions.end(); ++tit) {
+	for (size_t i = 0; i != block.transactions.size(); ++i) {
 		if (m_memory_state_total_complexity < MAX_POOL_COMPLEXITY * 2) {
-			auto thash = get_transaction_hash(*tit);
-			// undo is rare, otherwise we'd optimize to use
-			// block.header.transaction_hashes
-			add_transaction(thash, *tit, height, get_tip().timestamp + m_currency.block_future_time_limit * 2,
-			    std::numeric_limits<size_t>::max(), false);
+			const Hash &thash = block.header.transaction_hashes.at(i);
+			add_transaction(thash, block.transactions.at(i), height,
+			    get_tip().timestamp + m_currency.block_future_time_limit * 2, std::numeric_limits<size_t>::max(),
+			    false);
 			// we use increased timestamp so that just unlocked transactions will not
 			// be thrown out of the pool
 			// we set no limit on complexity to overshoot MAX_POOL_COMPLEXITY * 2 and
@@ -1009,12 +1162,39 @@ void BlockChainState::undo_block(const Hash &bhash, const Block &block, Height h
 }
 
 bool BlockChainState::read_block_output_global_indices(const Hash &bid, BlockGlobalIndices &indices) const {
-	BinaryArray rb;
+	DB::Value rb;
+	platform::DBKey key(BLOCK_GLOBAL_INDICES_PREFIX);
+	key.append(bid.data, sizeof(bid.data)).append(BLOCK_GLOBAL_INDICES_SUFFIX);
+	if (!m_db.get(key.view(), rb))
+		return false;
+	seria::from_binary(indices, rb.data(), rb.size());
+	return true;
+}
+
+bool BlockChainState::read_block_output_global_indices(
+    DB::Reader &reader, const Hash &bid, BlockGlobalIndices &indices) {
+	DB::Reader::Value rb;
+	platform::DBKey key(BLOCK_GLOBAL_INDICES_PREFIX);
+	key.append(bid.data, sizeof(bid.data)).append(BLOCK_GLOBAL_INDICES_SUFFIX);
+	if (!reader.get(key.view(), rb))
+		return false;
+	seria::from_binary(indices, rb.data(), rb.size());
+	return true;
+}
+
+bool BlockChainState::read_block_output_global_indices_data(const Hash &bid, BinaryArray &data) const {
 	auto key =
 	    BLOCK_GLOBAL_INDICES_PREFIX + DB::to_binary_key(bid.data, sizeof(bid.data)) + BLOCK_GLOBAL_INDICES_SUFFIX;
-	if (!m_db.get(key, rb))
+	return m_db.get(key, data);
+}
+
+bool BlockChainState::read_block_output_global_indices_data(DB::Reader &reader, const Hash &bid, BinaryArray &data) {
+	DB::Reader::Value rb;
+	platform::DBKey key(BLOCK_GLOBAL_INDICES_PREFIX);
+	key.append(bid.data, sizeof(bid.data)).append(BLOCK_GLOBAL_INDICES_SUFFIX);
+	if (!reader.get(key.view(), rb))
 		return false;
-	seria::from_binary(indices, rb);
+	data.assign(rb.data(), rb.data() + rb.size());
 	return true;
 }
 
@@ -1022,6 +1202,8 @@ std::vector<api::Output> BlockChainState::get_outputs_by_amount(
     Amount amount, size_t anonymity, Height height, Timestamp time) const {
 	std::vector<api::Output> result;
 	uint32_t total_count = next_global_index_for_amount(amount);
+	if (m_config.amount_output_cache && m_amount_outputs_cache.count(amount) == 0)
+		load_amount_outputs(amount);  // read_amount_output below will not touch DB
 	// We might need better algorithm if we have lots of locked amounts
 	if (total_count <= anonymity) {
 		for (uint32_t i = 0; i != total_count; ++i) {
@@ -1035,13 +1217,15 @@ std::vector<api::Output> BlockChainState::get_outputs_by_amount(
 		}
 		return result;
 	}
-	std::set<uint32_t> tried_or_added;
+	std::vector<uint32_t> tried_or_added;  // small, linear search is faster than set
+	tried_or_added.reserve(anonymity * 10);
 	uint32_t attempts = 0;
 	for (; result.size() < anonymity && attempts < anonymity * 10; ++attempts) {  // TODO - 10
 		uint32_t num = crypto::rand<uint32_t>();
 		num %= total_count;  // 0 handled in if above
-		if (!tried_or_added.insert(num).second)
+		if (std::find(tried_or_added.begin(), tried_or_added.end(), num) != tried_or_added.end())
 			continue;
+		tried_or_added.push_back(num);
 		api::Output item;
 		item.amount       = amount;
 		item.global_index = num;
@@ -1053,9 +1237,90 @@ std::vector<api::Output> BlockChainState::get_outputs_by_amount(
 	return result;
 }
 
+void BlockChainState::get_outputs_by_amounts(const std::vector<Amount> &amounts, size_t anonymity, Height height,
+    Timestamp time, std::map<Amount, std::vector<api::Output>> &result) const {
+	std::map<Amount, size_t> counts;  // repeated amounts are sampled together, so outputs do not repeat
+	for (Amount amount : amounts)
+		counts[amount] += anonymity;
+	for (auto &&co : counts) {
+		auto &outs = result[co.first];
+		if (!m_config.amount_output_cache) {
+			auto random_outputs = get_outputs_by_amount(co.first, co.second, height, time);
+			outs.insert(outs.end(), random_outputs.begin(), random_outputs.end());
+			continue;
+		}
+		if (m_amount_outputs_cache.count(co.first) == 0)
+			load_amount_outputs(co.first);
+		sample_amount_outputs(co.first, m_amount_outputs_cache.at(co.first), co.second, height, time, outs);
+	}
+}
+
+void BlockChainState::sample_amount_outputs(Amount amount, const AmountOutputs &ao, size_t count, Height height,
+    Timestamp time, std::vector<api::Output> &result) const {
+	const uint32_t total_count = static_cast<uint32_t>(ao.public_keys.size());
+	size_t found               = 0;
+	auto add_output = [&](uint32_t gi) {
+		if (!m_currency.is_transaction_spend_time_unlocked(ao.unlock_times[gi], height, time))
+			return;
+		api::Output item;
+		item.amount       = amount;
+		item.global_index = gi;
+		item.unlock_time  = ao.unlock_times[gi];
+		item.public_key   = ao.public_keys[gi];
+		result.push_back(item);
+		found += 1;
+	};
+	if (total_count <= count) {
+		for (uint32_t i = 0; i != total_count; ++i)
+			add_output(i);
+		return;
+	}
+	// Same attempts limit as get_outputs_by_amount. Each round draws indices for all missing outputs,
+	// then columns are read in ascending order
+	std::unordered_set<uint32_t> tried;  // sized by count, not by total_count which can be millions
+	tried.reserve(count * 2);
+	std::vector<uint32_t> round;
+	size_t attempts = 0;
+	while (found < count && attempts < count * 10) {
+		round.clear();
+		for (; round.size() < count - found && attempts < count * 10; ++attempts) {
+			const uint32_t num = crypto::rand<uint32_t>() % total_count;
+			if (!tried.insert(num).second)
+				continue;
+			round.push_back(num);
+		}
+		std::sort(round.begin(), round.end());
+		for (uint32_t gi : round)
+			add_output(gi);
+	}
+}
+
+void BlockChainState::load_amount_outputs(Amount amount) const {
+	AmountOutputs ao;  // built aside, so that exception does not leave partially loaded amount in cache
+	const uint32_t total_count = next_global_index_for_amount(amount);
+	ao.unlock_times.reserve(total_count);
+	ao.public_keys.reserve(total_count);
+	// Single sequential scan is much faster than random gets
+	for (DB::Cursor cur = m_db.begin(AMOUNT_OUTPUT_PREFIX + common::write_varint_sqlite4(amount)); !cur.end();
+	     cur.next()) {
+		if (common::read_varint_sqlite4(cur.get_suffix()) != ao.public_keys.size())
+			throw std::logic_error("Invariant dead - amount outputs are not continuous");
+		std::pair<uint64_t, PublicKey> was;
+		seria::from_binary(was, cur.get_value_array());
+		ao.unlock_times.push_back(was.first);
+		ao.public_keys.push_back(was.second);
+	}
+	if (ao.public_keys.size() != total_count)
+		throw std::logic_error("Invariant dead - amount outputs count mismatch");
+	m_amount_outputs_cache[amount] = std::move(ao);
+}
+
 void BlockChainState::store_keyimage(const KeyImage &keyimage, Height height) {
 	auto key = KEYIMAGE_PREFIX + DB::to_binary_key(keyimage.data, sizeof(keyimage.data));
 	m_db.put(key, std::string(), true);
+	m_keyimage_filter.insert(keyimage);
+	if (m_keyimage_filter.count > m_keyimage_filter.get_capacity())
+		rebuild_keyimage_filter(2 * m_keyimage_filter.get_capacity());
 }
 
 void BlockChainState::delete_keyimage(const KeyImage &keyimage) {
@@ -1064,9 +1329,70 @@ void BlockChainState::delete_keyimage(const KeyImage &keyimage) {
 }
 
 bool BlockChainState::read_keyimage(const KeyImage &keyimage) const {
-	auto key = KEYIMAGE_PREFIX + DB::to_binary_key(keyimage.data, sizeof(keyimage.data));
-	BinaryArray rb;
-	return m_db.get(key, rb);
+	if (!m_keyimage_filter.may_contain(keyimage))
+		return false;
+	platform::DBKey key(KEYIMAGE_PREFIX);
+	key.append(keyimage.data, sizeof(keyimage.data));
+	DB::Value rb;
+	return m_db.get(key.view(), rb);
+}
+
+void BlockChainState::load_keyimage_filter() {
+	BinaryArray ba;
+	if (m_db.get(KEYIMAGE_FILTER_KEY, ba)) {
+		try {
+			KeyImageFilter &kf = m_keyimage_filter;
+			seria::from_binary(kf, ba);
+			bool good = kf.tip_bid == get_tip_bid() && kf.get_capacity() != 0 &&
+			            (kf.bits.size() & (kf.bits.size() - 1)) == 0;
+			for (size_t i = 0; good && i != kf.get_chunk_count(); ++i) {
+				BinaryArray chunk;
+				const size_t offset = i * KeyImageFilter::CHUNK_SIZE;
+				good = m_db.get(KEYIMAGE_FILTER_CHUNK_PREFIX + common::write_varint_sqlite4(i), chunk) &&
+				       chunk.size() == std::min<size_t>(KeyImageFilter::CHUNK_SIZE, kf.bits.size() - offset);
+				if (good)
+					std::copy(chunk.begin(), chunk.end(), kf.bits.begin() + offset);
+			}
+			if (good) {
+				kf.changed_chunks.clear();
+				return;
+			}
+		} catch (const std::exception &) {
+		}
+	}
+	rebuild_keyimage_filter(0);
+}
+
+void BlockChainState::rebuild_keyimage_filter(size_t min_capacity) {
+	std::vector<KeyImage> keyimages;
+	for (DB::Cursor cur = m_db.begin(KEYIMAGE_PREFIX); !cur.end(); cur.next()) {
+		KeyImage keyimage;
+		DB::from_binary_key(cur.get_suffix(), 0, keyimage.data, sizeof(keyimage.data));
+		keyimages.push_back(keyimage);
+	}
+	m_log(logging::INFO) << "Rebuilding keyimage filter for " << keyimages.size() << " keyimages" << std::endl;
+	m_keyimage_filter = KeyImageFilter(std::max(min_capacity, 2 * keyimages.size()));
+	for (auto &&keyimage : keyimages)
+		m_keyimage_filter.insert(keyimage);
+	for (DB::Cursor cur = m_db.begin(KEYIMAGE_FILTER_CHUNK_PREFIX); !cur.end();)
+		cur.erase();  // size changed, so all chunks are rewritten on next commit
+	for (size_t i = 0; i != m_keyimage_filter.get_chunk_count(); ++i)
+		m_keyimage_filter.changed_chunks.insert(i);
+}
+
+void BlockChainState::db_commit() {
+	// Only chunks changed since last commit are written, full filter is tens of megabytes
+	KeyImageFilter &kf = m_keyimage_filter;
+	kf.tip_bid         = get_tip_bid();
+	m_db.put(KEYIMAGE_FILTER_KEY, seria::to_binary(kf), false);
+	for (size_t i : kf.changed_chunks) {
+		const size_t offset = i * KeyImageFilter::CHUNK_SIZE;
+		const size_t size   = std::min<size_t>(KeyImageFilter::CHUNK_SIZE, kf.bits.size() - offset);
+		m_db.put(KEYIMAGE_FILTER_CHUNK_PREFIX + common::write_varint_sqlite4(i),
+		    BinaryArray(kf.bits.begin() + offset, kf.bits.begin() + offset + size), false);
+	}
+	kf.changed_chunks.clear();
+	BlockChain::db_commit();
 }
 
 uint32_t BlockChainState::push_amount_output(Amount amount,
@@ -1092,6 +1418,11 @@ uint32_t BlockChainState::push_amount_output(Amount amount,
 		m_db.put(unkey, std::string(), true);
 	}
 	m_next_gi_for_amount[amount] += 1;
+	auto cit = m_amount_outputs_cache.find(amount);
+	if (cit != m_amount_outputs_cache.end()) {
+		cit->second.unlock_times.push_back(unlock_time);
+		cit->second.public_keys.push_back(pk);
+	}
 	return my_gi;
 }
 
@@ -1110,6 +1441,11 @@ void BlockChainState::pop_amount_output(Amount amount, UnlockMoment unlock_time,
 	if (was_unlock_time != unlock_time || was_pk != pk)
 		throw std::logic_error("BlockChainState::pop_amount_output popping wrong element");
 	m_db.del(key, true);
+	auto cit = m_amount_outputs_cache.find(amount);
+	if (cit != m_amount_outputs_cache.end()) {
+		cit->second.unlock_times.pop_back();
+		cit->second.public_keys.pop_back();
+	}
 
 	if (create_unlock_index &&
 	    !m_currency.is_transaction_spend_time_unlocked(unlock_time, get_tip_height(), get_tip().timestamp_unlock)) {
@@ -1138,12 +1474,21 @@ uint32_t BlockChainState::next_global_index_for_amount(Amount amount) const {
 
 bool BlockChainState::read_amount_output(
     Amount amount, uint32_t global_index, UnlockMoment &unlock_time, PublicKey &pk) const {
-	auto key = AMOUNT_OUTPUT_PREFIX + common::write_varint_sqlite4(amount) + common::write_varint_sqlite4(global_index);
-	BinaryArray rb;
-	if (!m_db.get(key, rb))
+	auto cit = m_amount_outputs_cache.find(amount);
+	if (cit != m_amount_outputs_cache.end()) {
+		if (global_index >= cit->second.public_keys.size())
+			return false;
+		unlock_time = cit->second.unlock_times[global_index];
+		pk          = cit->second.public_keys[global_index];
+		return true;
+	}
+	platform::DBKey key(AMOUNT_OUTPUT_PREFIX);
+	key.append(common::write_varint_sqlite4(amount)).append(common::write_varint_sqlite4(global_index));
+	DB::Value rb;
+	if (!m_db.get(key.view(), rb))
 		return false;
 	std::pair<uint64_t, PublicKey> was;
-	seria::from_binary(was, rb);
+	seria::from_binary(was, rb.data(), rb.size());
 	unlock_time = was.first;
 	pk          = was.second;
 	return true;
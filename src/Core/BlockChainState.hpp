@@ -38,6 +38,20 @@ struct RingSignatureArg {
 	std::vector<Signature> signatures;
 };
 
+// Ring signatures already verified (usually on pool admission), so that redo_block and mining template
+// do not check them again. Key covers everything check depends on, including resolved output keys
+class RingSignatureCache {
+	enum { MAX_SIZE = 1 << 16 };  // oldest are forgotten first
+	std::unordered_set<Hash> m_keys;
+	std::deque<Hash> m_order;
+
+public:
+	static Hash get_key(const Hash &tx_prefix_hash, const KeyImage &, const std::vector<PublicKey> &output_keys,
+	    const std::vector<Signature> &signatures);
+	bool contains(const Hash &key) const { return m_keys.count(key) != 0; }
+	void insert(const Hash &key);
+};
+
 class RingCheckerMulticore {
 	std::vector<std::thread> threads;
 	mutable std::mutex mu;
@@ -58,10 +72,29 @@ public:
 	~RingCheckerMulticore();
 	void cancel_work();
 	std::string start_work_get_error(IBlockChainState *state, const Currency &currency, const Block &block,
-	    Height unlock_height, Timestamp unlock_timestamp);  // can fail immediately
+	    Height unlock_height, Timestamp unlock_timestamp,
+	    const RingSignatureCache *cache);  // can fail immediately, signatures in cache are skipped
 	bool signatures_valid() const;
 };
 
+// Bloom filter of all spent keyimages, so that most read_keyimage misses do not touch DB.
+// Keyimages are curve points, so their bytes are used as hash values. Deleted keyimages stay
+// in filter (happens only on undo), this costs only extra DB lookups
+struct KeyImageFilter {
+	enum { BITS_PER_ITEM = 16, HASH_COUNT = 8, MIN_CAPACITY = 1 << 16, CHUNK_SIZE = 1 << 16 };
+	Hash tip_bid;  // DB state filter corresponds to, checked on load
+	uint64_t count = 0;
+	BinaryArray bits;                 // stored in DB by chunks of CHUNK_SIZE bytes
+	std::set<size_t> changed_chunks;  // written on next commit
+
+	size_t get_chunk_count() const { return (bits.size() + CHUNK_SIZE - 1) / CHUNK_SIZE; }
+
+	explicit KeyImageFilter(size_t capacity = 0);
+	size_t get_capacity() const { return bits.size() * 8 / BITS_PER_ITEM; }
+	void insert(const KeyImage &);
+	bool may_contain(const KeyImage &) const;
+};
+
 class BlockChainState : public BlockChain, private IBlockChainState {
 public:
 	BlockChainState(logging::ILogger &, const Config &, const Currency &);
@@ -70,12 +103,26 @@ public:
 	uint32_t get_next_effective_median_size() const;
 
 	std::vector<api::Output> get_outputs_by_amount(Amount, size_t anonymity, Height, Timestamp) const;
+	// Appends, repeating the same amount gives multiples of anonymity in result
+	void get_outputs_by_amounts(const std::vector<Amount> &, size_t anonymity, Height, Timestamp,
+	    std::map<Amount, std::vector<api::Output>> &result) const;
 	typedef std::vector<std::vector<uint32_t>> BlockGlobalIndices;
 	bool read_block_output_global_indices(const Hash &bid, BlockGlobalIndices &) const;
+	bool read_block_output_global_indices_data(const Hash &bid, BinaryArray &) const;  // as stored
+	static bool read_block_output_global_indices(DB::Reader &reader, const Hash &bid, BlockGlobalIndices &);
+	static bool read_block_output_global_indices_data(DB::Reader &reader, const Hash &bid, BinaryArray &);
+
+	struct PoolTransaction {  // size and fee are calculated once on admission
+		Transaction tx;
+		size_t binary_size  = 0;
+		Amount fee          = 0;
+		Amount fee_per_byte = 0;
 
+		PoolTransaction(const Transaction &tx, size_t binary_size, Amount fee);
+	};
 	BroadcastAction add_transaction(const Transaction &, Timestamp now);
 	uint32_t get_tx_pool_version() const { return m_tx_pool_version; }
-	typedef std::map<Hash, Transaction> TransMap;
+	typedef std::map<Hash, PoolTransaction> TransMap;
 	const TransMap &get_memory_state_transactions() const { return m_memory_state_tx; }
 
 	bool create_mining_block_template(
@@ -84,12 +131,13 @@ public:
 	Timestamp read_first_seen_timestamp(const Hash &tid) const;  // 0 if does not exist
 
 	static api::BlockHeader fill_genesis(Hash genesis_bid, const BlockTemplate &);
+	virtual void db_commit() override;
 
 protected:
-	std::string get_standalone_consensus_error(
-	    const PreparedBlock &pb, api::BlockHeader &info, const api::BlockHeader &prev_info) const;
-	virtual bool check_standalone_consensus(
-	    const PreparedBlock &pb, api::BlockHeader &info, const api::BlockHeader &prev_info) const override;
+	std::string get_standalone_consensus_error(const PreparedBlock &pb, api::BlockHeader &info,
+	    const api::BlockHeader &prev_info, Hash &long_hash) const;
+	virtual bool check_standalone_consensus(const PreparedBlock &pb, api::BlockHeader &info,
+	    const api::BlockHeader &prev_info, Hash &long_hash) const override;
 	virtual bool redo_block(const Hash &bhash, const Block &, const api::BlockHeader &) override;
 	virtual void undo_block(const Hash &bhash, const Block &, Height) override;
 
@@ -144,8 +192,22 @@ private:
 	mutable std::unordered_map<Amount, uint32_t>
 	    m_next_gi_for_amount;  // Read from db on first use, write on modification
 
+	struct AmountOutputs {  // columns indexed by global index
+		std::vector<UnlockMoment> unlock_times;
+		std::vector<PublicKey> public_keys;
+	};
+	// Only if m_config.amount_output_cache. Amounts are loaded on first get_outputs_by_amount, then kept in sync
+	mutable std::unordered_map<Amount, AmountOutputs> m_amount_outputs_cache;
+	void load_amount_outputs(Amount) const;
+	void sample_amount_outputs(Amount, const AmountOutputs &, size_t count, Height, Timestamp,
+	    std::vector<api::Output> &result) const;  // appends
+
 	void update_first_seen_timestamp(const Hash &tid, Timestamp now);  // 0 to delete
 
+	KeyImageFilter m_keyimage_filter;
+	void load_keyimage_filter();
+	void rebuild_keyimage_filter(size_t min_capacity);
+
 	BroadcastAction add_transaction(const Hash &tid, const Transaction &tx, Height unlock_height,
 	    Timestamp unlock_timestamp, size_t max_pool_complexity, bool check_sigs);
 	void remove_from_pool(Hash tid);
@@ -154,12 +216,26 @@ private:
 	                                 // because wallet resets to 1, so after both reset pool versions do not equal
 	TransMap m_memory_state_tx;
 	std::map<KeyImage, Hash> m_memory_state_ki_tx;
-	std::map<Amount, std::set<Hash>> m_memory_state_fee_tx;
+	std::map<Amount, std::set<Hash>> m_memory_state_fee_tx;  // by fee_per_byte, lowest are evicted first
 	size_t m_memory_state_total_complexity;
 	mutable std::map<Hash, std::pair<Transaction, Height>> m_mining_transactions;
 	// We remember them for several blocks
 	void clear_mining_transactions() const;
 
+	struct MiningTemplate {  // Everything except coinbase, which differs per miner
+		bool valid = false;
+		Hash tip_bid;
+		Difficulty difficulty = 0;
+		size_t max_txs_size   = 0;
+		std::vector<Hash> transaction_hashes;
+		size_t txs_size = 0;
+		Amount fee      = 0;
+		std::unique_ptr<DeltaState> memory_state;  // with all transaction_hashes applied
+	};
+	mutable MiningTemplate m_mining_template;  // rebuilt when tip changes or pool loses transaction
+	void rebuild_mining_template() const;
+	void add_to_mining_template(const Hash &tid, const PoolTransaction &ptx);
+
 	Timestamp m_next_median_timestamp = 0;
 	Timestamp m_next_unlock_timestamp = 0;
 	uint32_t m_next_median_size       = 0;
@@ -168,6 +244,7 @@ private:
 	    Timestamp &next_unlock_timestamp) const;
 
 	RingCheckerMulticore ring_checker;
+	mutable RingSignatureCache m_ring_signature_cache;
 	std::chrono::steady_clock::time_point log_redo_block_timestamp;
 };
 
@@ -5,6 +5,7 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
 #include <iostream>
+#include "BlockChainFileFormat.hpp"
 #include "CryptoNoteConfig.hpp"
 #include "common/Base64.hpp"
 #include "platform/PathTools.hpp"
@@ -46,7 +47,13 @@ Config::Config(common::CommandLine &cmd)
     , p2p_whitelist_connections_percent(P2P_DEFAULT_WHITELIST_CONNECTIONS_PERCENT)
     , p2p_block_ids_sync_default_count(BLOCKS_IDS_SYNCHRONIZING_DEFAULT_COUNT)
     , p2p_blocks_sync_default_count(BLOCKS_SYNCHRONIZING_DEFAULT_COUNT)
-    , rpc_get_blocks_fast_max_count(COMMAND_RPC_GET_BLOCKS_FAST_MAX_COUNT) {
+    , rpc_get_blocks_fast_max_count(COMMAND_RPC_GET_BLOCKS_FAST_MAX_COUNT)
+    , import_threads(0)
+    , import_preload_size(LegacyBlockChainReader::DEFAULT_MAX_PRELOAD_SIZE)
+    , api_threads(2)
+    , amount_output_cache(cmd.get_bool("--amount-output-cache"))
+    , db_background_sync(true)
+    , db_commit_blocks(0) {
 	common::pod_from_hex(P2P_STAT_TRUSTED_PUB_KEY, trusted_public_key);
 
 	if (is_testnet) {
@@ -110,6 +117,22 @@ Config::Config(common::CommandLine &cmd)
 				throw std::runtime_error("Wrong address format " + addr + ", should be ip:port");
 		}
 	}
+	if (const char *pa = cmd.get("--import-threads"))
+		import_threads = boost::lexical_cast<size_t>(pa);
+	if (const char *pa = cmd.get("--import-preload-mb"))
+		import_preload_size = boost::lexical_cast<size_t>(pa) * 1024 * 1024;
+	if (const char *pa = cmd.get("--api-threads"))
+		api_threads = boost::lexical_cast<size_t>(pa);
+	if (const char *pa = cmd.get("--db-sync")) {
+		if (std::string(pa) == "background")
+			db_background_sync = true;
+		else if (std::string(pa) == "commit")
+			db_background_sync = false;
+		else
+			throw std::runtime_error("Wrong --db-sync value " + std::string(pa) + ", should be commit or background");
+	}
+	if (const char *pa = cmd.get("--db-commit-blocks"))
+		db_commit_blocks = boost::lexical_cast<Height>(pa);
 	if (cmd.get_bool("--allow-local-ip"))
 		p2p_allow_local_ip = true;
 	for (auto &&pa : cmd.get_array("--seed-node-address"))
@@ -58,6 +58,13 @@ public:
 	size_t p2p_blocks_sync_default_count;
 	size_t rpc_get_blocks_fast_max_count;
 
+	size_t import_threads;       // 0 - use all cores for preparing blocks.bin
+	size_t import_preload_size;  // memory bound for blocks prepared ahead when importing blocks.bin
+	size_t api_threads;          // 0 - finish heavy API calls on main thread
+	bool amount_output_cache;  // keep outputs of amounts asked by get_random_outputs in memory
+	bool db_background_sync;   // commits wait for less disk work, last one can be lost after OS crash
+	Height db_commit_blocks;   // 0 - commit blockchain DB only on timer
+
 	std::vector<NetworkAddress> exclusive_nodes;
 	std::vector<NetworkAddress> seed_nodes;
 	std::vector<NetworkAddress> priority_nodes;  // Those nodes have reconnect and ban periods greatly reduced
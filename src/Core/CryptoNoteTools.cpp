@@ -7,6 +7,20 @@
 
 using namespace jetcash;
 
+std::vector<Hash> jetcash::get_binary_hashes(const std::vector<BinaryArray> &binaries) {
+	std::vector<const void *> data;
+	std::vector<size_t> lengths;
+	data.reserve(binaries.size());
+	lengths.reserve(binaries.size());
+	for (auto &&ba : binaries) {
+		data.push_back(ba.data());
+		lengths.push_back(ba.size());
+	}
+	std::vector<Hash> result(binaries.size());
+	crypto::cn_fast_hash_batch(data.data(), lengths.data(), binaries.size(), result.data());
+	return result;
+}
+
 Hash jetcash::get_base_transaction_hash(const BaseTransaction &tx) {
 	if (tx.version < 2)
 		return get_object_hash(tx);
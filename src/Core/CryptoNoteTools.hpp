@@ -18,6 +18,9 @@ Hash get_object_hash(const T &object, size_t *size = nullptr) {
 	return crypto::cn_fast_hash(ba.data(), ba.size());
 }
 
+// Same as hashing every binary separately, but several are hashed at once
+std::vector<Hash> get_binary_hashes(const std::vector<BinaryArray> &binaries);
+
 Hash get_base_transaction_hash(const BaseTransaction &tx);
 
 void decompose_amount(Amount amount, Amount dust_threshold, std::vector<Amount> &decomposed_amounts);
@@ -551,15 +551,17 @@ Hash jetcash::get_auxiliary_block_header_hash(const BlockTemplate &bh) {
 	return get_object_hash(get_block_hashing_binary_array(bh));
 }
 
-Hash jetcash::get_block_long_hash(const BlockTemplate &bh, crypto::CryptoNightContext &crypto_ctx) {
-	if (bh.major_version == 1) {
-		auto raw_hashing_block = get_block_hashing_binary_array(bh);
-		return crypto_ctx.cn_slow_hash(raw_hashing_block.data(), raw_hashing_block.size());
-	}
+BinaryArray jetcash::get_block_long_hashing_data(const BlockTemplate &bh) {
+	if (bh.major_version == 1)
+		return get_block_hashing_binary_array(bh);
 	if (bh.major_version >= 2) {
-		auto serializer               = make_parent_block_serializer(bh, true, true);
-		BinaryArray raw_hashing_block = seria::to_binary(serializer);
-		return crypto_ctx.cn_slow_hash(raw_hashing_block.data(), raw_hashing_block.size());
+		auto serializer = make_parent_block_serializer(bh, true, true);
+		return seria::to_binary(serializer);
 	}
 	throw std::runtime_error("Unknown block major version.");
 }
+
+Hash jetcash::get_block_long_hash(const BlockTemplate &bh, crypto::CryptoNightContext &crypto_ctx) {
+	BinaryArray raw_hashing_block = get_block_long_hashing_data(bh);
+	return crypto_ctx.cn_slow_hash(raw_hashing_block.data(), raw_hashing_block.size());
+}
@@ -121,6 +121,7 @@ Hash get_transaction_hash(const Transaction &);
 
 Hash get_block_hash(const BlockTemplate &);
 Hash get_block_long_hash(const BlockTemplate &, crypto::CryptoNightContext &);
+BinaryArray get_block_long_hashing_data(const BlockTemplate &);  // input of get_block_long_hash, for cn_slow_hash2
 Hash get_auxiliary_block_header_hash(const BlockTemplate &);  // Without parent block, for merge mining calculations
 
 }  // namespace jetcash
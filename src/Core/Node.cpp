@@ -20,6 +20,7 @@ using namespace jetcash;
 Node::Node(logging::ILogger &log, const Config &config, BlockChainState &block_chain)
     : m_block_chain(block_chain)
     , m_config(config)
+    , m_api_workers(config.api_threads)
     , m_block_chain_was_far_behind(true)
     , m_log(log, "Node")
     , m_peer_db(config)
@@ -30,13 +31,15 @@ Node::Node(logging::ILogger &log, const Config &config, BlockChainState &block_c
 	const std::string new_path = config.get_data_folder();
 
 	if (!config.is_testnet) {
-		m_block_chain_reader1 =
-		    std::make_unique<LegacyBlockChainReader>(new_path + "/blockindexes.bin", new_path + "/blocks.bin");
+		m_block_chain_reader1 = std::make_unique<LegacyBlockChainReader>(
+		    new_path + "/blockindexes.bin", new_path + "/blocks.bin", config.import_threads,
+		    config.import_preload_size);
 		if (m_block_chain_reader1->get_block_count() <= block_chain.get_tip_height())
 			m_block_chain_reader1.reset();
 		if (new_path != old_path) {  // Current situation on Linux
-			m_block_chain_reader2 =
-			    std::make_unique<LegacyBlockChainReader>(old_path + "/blockindexes.bin", old_path + "/blocks.bin");
+			m_block_chain_reader2 = std::make_unique<LegacyBlockChainReader>(
+			    old_path + "/blockindexes.bin", old_path + "/blocks.bin", config.import_threads,
+			    config.import_preload_size);
 			if (m_block_chain_reader2->get_block_count() <= block_chain.get_tip_height())
 				m_block_chain_reader2.reset();
 		}
@@ -47,11 +50,17 @@ Node::Node(logging::ILogger &log, const Config &config, BlockChainState &block_c
 		    config.ssl_certificate_pem_file,
 		    config.ssl_certificate_password ? config.ssl_certificate_password.get() : std::string()));
 
+	m_commit_height = block_chain.get_tip_height();
 	m_commit_timer.once(DB_COMMIT_PERIOD_JETCASHD);
 	advance_long_poll();
 }
 
 bool Node::on_idle() {
+	m_api_workers.on_idle();
+	add_new_blocks();
+	if (m_config.db_commit_blocks != 0 &&
+	    m_block_chain.get_tip_height() >= m_commit_height + m_config.db_commit_blocks)
+		db_commit();
 	if (!m_block_chain_reader1 && !m_block_chain_reader2 &&
 	    m_block_chain.get_tip_height() >= m_block_chain.internal_import_known_height())
 		return m_downloader.on_idle();
@@ -72,7 +81,7 @@ bool Node::on_idle() {
 
 void Node::sync_transactions(P2PClientJetcash *who) {
 	NOTIFY_REQUEST_TX_POOL::request msg;
-	auto mytxs = m_block_chain.get_memory_state_transactions();
+	const auto &mytxs = m_block_chain.get_memory_state_transactions();
 	msg.txs.reserve(mytxs.size());
 	for (auto &&tx : mytxs) {
 		msg.txs.push_back(tx.first);
@@ -165,6 +174,9 @@ void Node::P2PClientJetcash::on_msg_notify_request_objects(NOTIFY_RESPONSE_GET_O
 
 void Node::P2PClientJetcash::on_disconnect(const std::string &ban_reason) {
 	m_node->m_downloader.on_disconnect(this);
+	m_node->m_new_block_preparator.on_disconnect(this);
+	m_compact_blocks.clear();  // instances are reused between connects
+	m_compact_blocks_order.clear();
 
 	P2PClientBasic::on_disconnect(ban_reason);
 	m_node->advance_long_poll();
@@ -172,7 +184,7 @@ void Node::P2PClientJetcash::on_disconnect(const std::string &ban_reason) {
 
 void Node::P2PClientJetcash::on_msg_notify_request_tx_pool(NOTIFY_REQUEST_TX_POOL::request &&req) {
 	NOTIFY_NEW_TRANSACTIONS::request msg;
-	auto mytxs = m_node->m_block_chain.get_memory_state_transactions();
+	const auto &mytxs = m_node->m_block_chain.get_memory_state_transactions();
 	msg.txs.reserve(mytxs.size());
 	std::sort(req.txs.begin(), req.txs.end());  // Should have been sorted on wire,
 	                                            // checked here, but alas, legacy
@@ -180,7 +192,7 @@ void Node::P2PClientJetcash::on_msg_notify_request_tx_pool(NOTIFY_REQUEST_TX_POO
 		auto it = std::lower_bound(req.txs.begin(), req.txs.end(), tx.first);
 		if (it != req.txs.end() && *it == tx.first)
 			continue;
-		BinaryArray raw_tx = seria::to_binary(tx.second);
+		BinaryArray raw_tx = seria::to_binary(tx.second.tx);
 		msg.txs.push_back(std::move(raw_tx));
 	}
 	if (msg.txs.empty())
@@ -197,26 +209,244 @@ void Node::P2PClientJetcash::on_msg_timed_sync(COMMAND_TIMED_SYNC::response &&re
 }
 
 void Node::P2PClientJetcash::on_msg_notify_new_block(NOTIFY_NEW_BLOCK::request &&req) {
-	RawBlock raw_block{req.b.block, req.b.transactions};
-	PreparedBlock pb(std::move(raw_block), nullptr);
-	api::BlockHeader info;
-	auto action = m_node->m_block_chain.add_block(pb, info);
-	switch (action) {
-	case BroadcastAction::BAN:
-		disconnect("NOTIFY_NEW_BLOCK add_block BAN");
+	BlockTemplate block_template;
+	try {
+		seria::from_binary(block_template, req.b.block);
+	} catch (const std::exception &ex) {
+		disconnect("NOTIFY_NEW_BLOCK from_binary failed " + std::string(ex.what()));
 		return;
-	case BroadcastAction::BROADCAST_ALL: {
-		req.hop += 1;
-		BinaryArray raw_msg = LevinProtocol::send_message(NOTIFY_NEW_BLOCK::ID, LevinProtocol::encode(req), false);
-		m_node->m_p2p.broadcast(this, raw_msg);
-		m_node->advance_long_poll();
+	}
+	add_new_block(get_block_hash(block_template), std::move(req));
+}
+
+void Node::P2PClientJetcash::add_new_block(const Hash &bid, NOTIFY_NEW_BLOCK::request &&req) {
+	if (m_node->m_block_chain.has_block(bid))
+		return;  // relayed by several peers
+	Hash long_hash;  // main thread owns DB, so we look for stored PoW hash here
+	const bool calculate_pow = !m_node->m_block_chain.read_long_hash(bid, long_hash);
+	if (!m_node->m_new_block_preparator.add_work(this, bid, calculate_pow, std::move(req)))
+		disconnect("NOTIFY_NEW_BLOCK too many blocks waiting for preparation");
+}
+
+void Node::P2PClientJetcash::on_msg_notify_new_compact_block(NOTIFY_NEW_COMPACT_BLOCK::request &&req) {
+	BlockTemplate block_template;
+	try {
+		seria::from_binary(block_template, req.block);
+	} catch (const std::exception &ex) {
+		disconnect("NOTIFY_NEW_COMPACT_BLOCK from_binary failed " + std::string(ex.what()));
 		return;
 	}
-	case BroadcastAction::NOTHING:
-		break;
+	const Hash bid = get_block_hash(block_template);
+	if (m_compact_blocks.count(bid) != 0 || m_node->m_block_chain.has_block(bid))
+		return;
+	CompactBlock cb;
+	cb.req.b.block                   = std::move(req.block);
+	cb.req.current_blockchain_height = req.current_blockchain_height;
+	cb.req.hop                       = req.hop;
+	cb.req.b.transactions.resize(block_template.transaction_hashes.size());
+	const auto &pool = m_node->m_block_chain.get_memory_state_transactions();
+	for (size_t i = 0; i != block_template.transaction_hashes.size(); ++i) {
+		auto tit = pool.find(block_template.transaction_hashes.at(i));
+		if (tit == pool.end())
+			cb.missing_indexes.push_back(static_cast<uint32_t>(i));
+		else
+			cb.req.b.transactions.at(i) = seria::to_binary(tit->second.tx);
+	}
+	if (cb.missing_indexes.empty()) {
+		add_new_block(bid, std::move(cb.req));
+		return;
+	}
+	if (m_compact_blocks.size() >= MAX_COMPACT_BLOCKS) {  // peer does not answer, forget oldest
+		m_compact_blocks.erase(m_compact_blocks_order.front());
+		m_compact_blocks_order.pop_front();
+	}
+	NOTIFY_REQUEST_BLOCK_TRANSACTIONS::request msg;
+	msg.block_hash        = bid;
+	msg.indexes           = cb.missing_indexes;
+	cb.transaction_hashes = std::move(block_template.transaction_hashes);
+	m_compact_blocks[bid] = std::move(cb);
+	m_compact_blocks_order.push_back(bid);
+	BinaryArray raw_msg =
+	    LevinProtocol::send_message(NOTIFY_REQUEST_BLOCK_TRANSACTIONS::ID, LevinProtocol::encode(msg), false);
+	send(std::move(raw_msg));
+}
+
+void Node::P2PClientJetcash::on_msg_notify_block_transactions(NOTIFY_REQUEST_BLOCK_TRANSACTIONS::request &&req) {
+	RawBlock raw_block;  // we relay only after adding block, so it is in DB
+	if (!m_node->m_block_chain.read_block(req.block_hash, raw_block))
+		return;
+	if (req.indexes.size() > raw_block.transactions.size()) {
+		disconnect("NOTIFY_REQUEST_BLOCK_TRANSACTIONS too many indexes");
+		return;
+	}
+	NOTIFY_RESPONSE_BLOCK_TRANSACTIONS::request msg;
+	msg.block_hash = req.block_hash;
+	for (size_t i = 0; i != req.indexes.size(); ++i) {
+		const uint32_t index = req.indexes.at(i);
+		if (index >= raw_block.transactions.size()) {
+			disconnect("NOTIFY_REQUEST_BLOCK_TRANSACTIONS index out of range");
+			return;
+		}
+		if (i != 0 && index <= req.indexes.at(i - 1)) {  // otherwise small request gets huge response
+			disconnect("NOTIFY_REQUEST_BLOCK_TRANSACTIONS indexes must strictly increase");
+			return;
+		}
+		msg.indexes.push_back(index);
+		msg.txs.push_back(raw_block.transactions.at(index));
+	}
+	BinaryArray raw_msg =
+	    LevinProtocol::send_message(NOTIFY_RESPONSE_BLOCK_TRANSACTIONS::ID, LevinProtocol::encode(msg), false);
+	send(std::move(raw_msg));
+}
+
+void Node::P2PClientJetcash::on_msg_notify_block_transactions(NOTIFY_RESPONSE_BLOCK_TRANSACTIONS::request &&req) {
+	auto cit = m_compact_blocks.find(req.block_hash);
+	if (cit == m_compact_blocks.end())
+		return;  // forgotten
+	CompactBlock &cb = cit->second;
+	if (req.indexes != cb.missing_indexes || req.txs.size() != req.indexes.size()) {
+		disconnect("NOTIFY_RESPONSE_BLOCK_TRANSACTIONS wrong indexes");
+		return;
+	}
+	for (size_t i = 0; i != req.indexes.size(); ++i) {
+		const uint32_t index = req.indexes.at(i);
+		Transaction tx;
+		try {
+			seria::from_binary(tx, req.txs.at(i));
+		} catch (const std::exception &ex) {
+			disconnect("NOTIFY_RESPONSE_BLOCK_TRANSACTIONS from_binary failed " + std::string(ex.what()));
+			return;
+		}
+		if (get_transaction_hash(tx) != cb.transaction_hashes.at(index)) {
+			disconnect("NOTIFY_RESPONSE_BLOCK_TRANSACTIONS wrong transaction hash");
+			return;
+		}
+		cb.req.b.transactions.at(index) = std::move(req.txs.at(i));
+	}
+	NOTIFY_NEW_BLOCK::request new_block = std::move(cb.req);
+	const Hash bid                      = cit->first;
+	m_compact_blocks.erase(cit);  // add_new_block can disconnect, which clears m_compact_blocks
+	m_compact_blocks_order.erase(std::find(m_compact_blocks_order.begin(), m_compact_blocks_order.end(), bid));
+	add_new_block(bid, std::move(new_block));
+}
+
+Node::NewBlockPreparator::NewBlockPreparator() {
+	main_loop = platform::EventLoop::current();
+	thread    = std::thread(&NewBlockPreparator::thread_run, this);
+}
+
+Node::NewBlockPreparator::~NewBlockPreparator() {
+	{
+		std::unique_lock<std::mutex> lock(mu);
+		quit = true;
+		have_work.notify_all();
+	}
+	thread.join();
+}
+
+bool Node::NewBlockPreparator::add_work(
+    P2PClientJetcash *who, const Hash &bid, bool calculate_pow, NOTIFY_NEW_BLOCK::request &&req) {
+	std::unique_lock<std::mutex> lock(mu);
+	for (auto &&wo : works)
+		if (wo.bid == bid)
+			return true;  // already got from another peer
+	if (works.size() >= MAX_WORKS)
+		return false;
+	works.emplace_back();
+	works.back().who = who;
+	works.back().bid           = bid;
+	works.back().calculate_pow = calculate_pow;
+	works.back().req           = std::move(req);
+	have_work.notify_all();
+	return true;
+}
+
+void Node::NewBlockPreparator::on_disconnect(P2PClientJetcash *who) {
+	std::unique_lock<std::mutex> lock(mu);
+	for (auto &&wo : works)
+		if (wo.who == who)
+			wo.who = nullptr;
+}
+
+bool Node::NewBlockPreparator::get_prepared(
+    P2PClientJetcash *&who, NOTIFY_NEW_BLOCK::request &req, PreparedBlock &pb) {
+	std::unique_lock<std::mutex> lock(mu);
+	if (prepared_counter == 0)
+		return false;
+	who = works.front().who;
+	req = std::move(works.front().req);
+	pb  = std::move(works.front().pb);
+	works.pop_front();
+	prepared_counter -= 1;
+	return true;
+}
+
+void Node::NewBlockPreparator::thread_run() {
+	crypto::CryptoNightContext hash_crypto_context;
+	while (true) {
+		RawBlock raw_block;
+		bool calculate_pow = true;
+		{
+			std::unique_lock<std::mutex> lock(mu);
+			if (quit)
+				return;
+			if (prepared_counter == works.size()) {
+				have_work.wait(lock);
+				continue;
+			}
+			const Work &wo = works.at(prepared_counter);  // main thread does not erase unprepared
+			raw_block      = RawBlock{wo.req.b.block, wo.req.b.transactions};
+			calculate_pow  = wo.calculate_pow;
+		}
+		PreparedBlock result(std::move(raw_block), calculate_pow ? &hash_crypto_context : nullptr);
+		{
+			std::unique_lock<std::mutex> lock(mu);
+			works.at(prepared_counter).pb = std::move(result);
+			prepared_counter += 1;
+			main_loop->wake();  // so we add block in on_idle
+		}
+	}
+}
+
+void Node::add_new_blocks() {
+	P2PClientJetcash *who = nullptr;
+	NOTIFY_NEW_BLOCK::request req;
+	PreparedBlock pb;
+	while (m_new_block_preparator.get_prepared(who, req, pb)) {
+		api::BlockHeader info;
+		auto action = m_block_chain.add_block(pb, info);
+		switch (action) {
+		case BroadcastAction::BAN:
+			if (who)
+				who->disconnect("NOTIFY_NEW_BLOCK add_block BAN");
+			break;
+		case BroadcastAction::BROADCAST_ALL: {
+			req.hop += 1;
+			broadcast_new_block(who, req);
+			advance_long_poll();
+			break;
+		}
+		case BroadcastAction::NOTHING:
+			break;
+		}
 	}
 }
 
+void Node::broadcast_new_block(P2PClientJetcash *exclude_who, const NOTIFY_NEW_BLOCK::request &req) {
+	NOTIFY_NEW_COMPACT_BLOCK::request compact_req;
+	compact_req.block                     = req.b.block;
+	compact_req.current_blockchain_height = req.current_blockchain_height;
+	compact_req.hop                       = req.hop;
+	BinaryArray raw_msg = LevinProtocol::send_message(NOTIFY_NEW_BLOCK::ID, LevinProtocol::encode(req), false);
+	BinaryArray raw_compact_msg =
+	    LevinProtocol::send_message(NOTIFY_NEW_COMPACT_BLOCK::ID, LevinProtocol::encode(compact_req), false);
+	// all our clients are P2PClientJetcash
+	m_p2p.broadcast(exclude_who, std::move(raw_msg),
+	    [](const P2PClient *cli) { return static_cast<const P2PClientBasic *>(cli)->get_version() < V2; });
+	m_p2p.broadcast(exclude_who, std::move(raw_compact_msg),
+	    [](const P2PClient *cli) { return static_cast<const P2PClientBasic *>(cli)->get_version() >= V2; });
+}
+
 void Node::P2PClientJetcash::on_msg_notify_new_transactions(NOTIFY_NEW_TRANSACTIONS::request &&req) {
 	if (m_node->m_block_chain_reader1 || m_node->m_block_chain_reader2 ||
 	    m_node->m_block_chain.get_tip_height() < m_node->m_block_chain.internal_import_known_height())
@@ -245,7 +475,7 @@ void Node::P2PClientJetcash::on_msg_notify_new_transactions(NOTIFY_NEW_TRANSACTI
 	if (msg.txs.empty())
 		return;
 	BinaryArray raw_msg = LevinProtocol::send_message(NOTIFY_NEW_TRANSACTIONS::ID, LevinProtocol::encode(msg), false);
-	m_node->m_p2p.broadcast(this, raw_msg);
+	m_node->m_p2p.broadcast(this, std::move(raw_msg));
 	m_node->advance_long_poll();
 }
 
@@ -404,6 +634,7 @@ bool Node::on_api_http_request(http::Client *who, http::RequestData &&request, h
 }
 
 void Node::on_api_http_disconnect(http::Client *who) {
+	m_api_workers.on_disconnect(who);
 	for (auto lit = m_long_poll_http_clients.begin(); lit != m_long_poll_http_clients.end();)
 		if (lit->original_who == who)
 			lit = m_long_poll_http_clients.erase(lit);
@@ -411,6 +642,106 @@ void Node::on_api_http_disconnect(http::Client *who) {
 			++lit;
 }
 
+Node::APIWorkers::APIWorkers(size_t thread_count) {
+	for (size_t i = 0; i != thread_count; ++i)
+		threads.emplace_back(&APIWorkers::thread_run, this);
+	main_loop = platform::EventLoop::current();
+}
+
+Node::APIWorkers::~APIWorkers() {
+	{
+		std::unique_lock<std::mutex> lock(mu);
+		quit = true;
+		have_work.notify_all();
+	}
+	for (auto &&th : threads)
+		th.join();
+}
+
+void Node::APIWorkers::add_work(http::Client *who, const http::RequestData &original_request, bool json,
+    const json_rpc::OptionalJsonValue &json_id, Job &&job) {
+	std::unique_lock<std::mutex> lock(mu);
+	works.emplace_back();
+	Work &wo    = works.back();
+	wo.who      = who;
+	wo.response = http::ResponseData(original_request.r);
+	wo.response.r.add_headers_nocache();
+	wo.response.r.status = 200;
+	wo.json              = json;
+	wo.json_id           = json_id;
+	wo.job               = std::move(job);
+	work_queue.push_back(&wo);
+	have_work.notify_all();
+}
+
+void Node::APIWorkers::on_disconnect(http::Client *who) {
+	std::unique_lock<std::mutex> lock(mu);
+	for (auto &&wo : works)
+		if (wo.who == who)
+			wo.who = nullptr;
+}
+
+void Node::APIWorkers::on_idle() {
+	while (true) {
+		http::Client *who = nullptr;
+		http::ResponseData response;
+		{
+			std::unique_lock<std::mutex> lock(mu);
+			auto wit = std::find_if(works.begin(), works.end(), [](const Work &wo) { return wo.ready; });
+			if (wit == works.end())
+				return;
+			who      = wit->who;
+			response = std::move(wit->response);
+			works.erase(wit);
+		}
+		if (who)  // write can call handlers, so without lock
+			who->write(std::move(response));
+	}
+}
+
+void Node::APIWorkers::set_error(Work &wo, const json_rpc::Error &err) {
+	if (!wo.json) {
+		wo.response.r.status = 500;
+		wo.response.set_body(std::string());
+		return;
+	}
+	json_rpc::Response json_resp;
+	json_resp.set_id(wo.json_id);
+	json_resp.set_error(err);
+	wo.response.set_body(json_resp.get_body());
+	wo.response.r.headers.push_back({"Content-Type", "application/json; charset=utf-8"});
+}
+
+void Node::APIWorkers::thread_run() {
+	while (true) {
+		Work *wo = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(mu);
+			if (quit)
+				return;
+			if (work_queue.empty()) {
+				have_work.wait(lock);
+				continue;
+			}
+			wo = work_queue.front();
+			work_queue.pop_front();
+		}
+		try {
+			wo->job(wo->response);
+		} catch (const json_rpc::Error &err) {  // same as process_json_rpc_request for synchronous handlers
+			set_error(*wo, err);
+		} catch (const std::exception &ex) {
+			set_error(*wo, json_rpc::Error(json_rpc::INTERNAL_ERROR, ex.what()));
+		}
+		wo->job = Job{};  // free captured data before main thread sees result
+		{
+			std::unique_lock<std::mutex> lock(mu);
+			wo->ready = true;
+			main_loop->wake();  // so we write response in on_idle
+		}
+	}
+}
+
 namespace {
 
 template<typename CommandRequest, typename CommandResponse>
@@ -436,6 +767,7 @@ Node::HTTPHandlerFunction bin_method(bool (Node::*handler)(http::Client *who, ht
 const std::unordered_map<std::string, Node::HTTPHandlerFunction> Node::m_http_handlers = {
 
     {api::jetcashd::SyncBlocks::bin_method(), bin_method(&Node::on_wallet_sync3)},
+    {api::jetcashd::SyncBlocksRaw::bin_method(), bin_method(&Node::on_wallet_sync_raw3)},
     {api::jetcashd::SyncMemPool::bin_method(), bin_method(&Node::on_sync_mempool3)},
     {"/json_rpc", std::bind(&Node::process_json_rpc_request, std::placeholders::_1, std::placeholders::_2,
                       std::placeholders::_3, std::placeholders::_4)}};
@@ -461,12 +793,8 @@ bool Node::on_get_random_outputs3(http::Client *, http::RequestData &&, json_rpc
 		request.confirmed_height_or_depth = std::max(
 		    0, static_cast<api::HeightOrDepth>(m_block_chain.get_tip_height()) + 1 + request.confirmed_height_or_depth);
 	api::BlockHeader tip_header = m_block_chain.get_tip();
-	for (uint64_t amount : request.amounts) {
-		auto random_outputs = m_block_chain.get_outputs_by_amount(
-		    amount, request.outs_count, request.confirmed_height_or_depth, tip_header.timestamp);
-		auto &outs = response.outputs[amount];
-		outs.insert(outs.end(), random_outputs.begin(), random_outputs.end());
-	}
+	m_block_chain.get_outputs_by_amounts(request.amounts, request.outs_count, request.confirmed_height_or_depth,
+	    tip_header.timestamp, response.outputs);
 	return true;
 }
 
@@ -509,28 +837,26 @@ bool Node::on_get_status3(http::Client *who, http::RequestData &&raw_request, js
 	return true;
 }
 
-bool Node::on_wallet_sync3(http::Client *, http::RequestData &&, json_rpc::Request &&json_req,
-    api::jetcashd::SyncBlocks::Request &&req, api::jetcashd::SyncBlocks::Response &res) {
+bool Node::get_wallet_sync_supplement(
+    const api::jetcashd::SyncBlocks::Request &req, Height &start_block_index, std::vector<Hash> &supplement) const {
 	if (req.sparse_chain.empty()) {
 		//        res.status = "Empty sparse chain";
-		return true;
+		return false;
 	}
 
 	if (req.sparse_chain.back() != m_block_chain.get_genesis_bid()) {
 		//        res.status = "Different currency";
-		return true;
+		return false;
 	}
 	if (req.max_count > api::jetcashd::SyncBlocks::Request::MAX_COUNT) {
 		//        res.status = "max_count too big";
-		return true;
+		return false;
 	}
 	auto first_block_timestamp = req.first_block_timestamp < m_block_chain.get_currency().block_future_time_limit
 	                                 ? 0
 	                                 : req.first_block_timestamp - m_block_chain.get_currency().block_future_time_limit;
 	Height full_offset = m_block_chain.get_timestamp_lower_bound_block_index(first_block_timestamp);
-	Height start_block_index;
-	std::vector<crypto::Hash> supplement =
-	    m_block_chain.get_sync_headers_chain(req.sparse_chain, start_block_index, req.max_count);
+	supplement         = m_block_chain.get_sync_headers_chain(req.sparse_chain, start_block_index, req.max_count);
 	if (full_offset >= start_block_index + supplement.size()) {
 		start_block_index = full_offset;
 		supplement.clear();
@@ -544,36 +870,137 @@ bool Node::on_wallet_sync3(http::Client *, http::RequestData &&, json_rpc::Reque
 		supplement.erase(supplement.begin(), supplement.begin() + (full_offset - start_block_index));
 		start_block_index = full_offset;
 	}
+	return true;
+}
+
+namespace {
+
+template<typename Response>
+void set_api_response_body(
+    bool json, const json_rpc::OptionalJsonValue &id, const Response &res, http::ResponseData &response) {
+	if (!json) {
+		response.set_body(seria::to_binary_str(res));
+		return;
+	}
+	json_rpc::Response json_resp;
+	json_resp.set_id(id);
+	json_resp.set_result(res);
+	response.set_body(json_resp.get_body());
+	response.r.headers.push_back({"Content-Type", "application/json; charset=utf-8"});  // after anything can throw
+}
 
+void decode_sync_blocks(std::vector<RawBlock> &raw_blocks, api::jetcashd::SyncBlocks::Response &res) {
+	std::vector<BinaryArray> base_transactions(raw_blocks.size());
+	for (size_t i = 0; i != raw_blocks.size(); ++i) {
+		Block block;
+		if (!block.from_raw_block(raw_blocks[i]))
+			throw std::logic_error("RawBlock failed to convert into block");
+		base_transactions[i]    = seria::to_binary(block.header.base_transaction);
+		res.blocks[i].bc_header = std::move(block.header);
+		res.blocks[i].bc_transactions.reserve(block.transactions.size());
+		for (auto &&tx : block.transactions)
+			res.blocks[i].bc_transactions.push_back(std::move(tx));
+	}
+	const auto base_transaction_hashes = get_binary_hashes(base_transactions);  // hashed together, much faster
+	for (size_t i = 0; i != raw_blocks.size(); ++i)
+		res.blocks[i].base_transaction_hash = base_transaction_hashes[i];
+}
+}  // anonymous namespace
+
+bool Node::on_wallet_sync3(http::Client *who, http::RequestData &&raw_request, json_rpc::Request &&json_req,
+    api::jetcashd::SyncBlocks::Request &&req, api::jetcashd::SyncBlocks::Response &res) {
+	Height start_block_index = 0;
+	std::vector<Hash> supplement;
+	if (!get_wallet_sync_supplement(req, start_block_index, supplement))
+		return true;
 	res.start_height = start_block_index;
 	res.blocks.resize(supplement.size());
-	for (size_t i = 0; i != supplement.size(); ++i) {
+	std::vector<RawBlock> raw_blocks(supplement.size());
+	const size_t worker_count = get_worker_read_count(start_block_index, supplement.size());
+	for (size_t i = worker_count; i != supplement.size(); ++i) {
 		auto bhash = supplement[i];
 		if (!m_block_chain.read_header(bhash, res.blocks[i].header))
 			throw std::logic_error("Block header must be there, but it is not there");
-		BlockChainState::BlockGlobalIndices global_indices;
 		// if (res.blocks[i].header.timestamp >= req.first_block_timestamp) //
 		// commented out becuase empty Block cannot be serialized
-		{
-			RawBlock rb;
-			if (!m_block_chain.read_block(bhash, rb))
-				throw std::logic_error("Block must be there, but it is not there");
-			Block block;
-			if (!block.from_raw_block(rb))
-				throw std::logic_error("RawBlock failed to convert into block");
-			res.blocks[i].base_transaction_hash = get_transaction_hash(block.header.base_transaction);
-			res.blocks[i].bc_header             = std::move(block.header);
-			res.blocks[i].bc_transactions.reserve(block.transactions.size());
-			for (auto &&tx : block.transactions)
-				res.blocks[i].bc_transactions.push_back(std::move(tx));
-			if (!m_block_chain.read_block_output_global_indices(bhash, res.blocks[i].global_indices))
-				throw std::logic_error(
-				    "Invariant dead - bid is in chain but "
-				    "blockchain has no block indices");
-		}
+		if (!m_block_chain.read_block(bhash, raw_blocks[i]))
+			throw std::logic_error("Block must be there, but it is not there");
+		if (!m_block_chain.read_block_output_global_indices(bhash, res.blocks[i].global_indices))
+			throw std::logic_error(
+			    "Invariant dead - bid is in chain but "
+			    "blockchain has no block indices");
 	}
 	res.status = create_status_response3();
-	return true;
+	if (m_api_workers.empty()) {
+		decode_sync_blocks(raw_blocks, res);
+		return true;
+	}
+	const bool json = raw_request.r.uri != api::jetcashd::SyncBlocks::bin_method();
+	m_api_workers.add_work(who, raw_request, json, json_req.get_id(),
+	    [json, id = json_req.get_id(), &db = m_block_chain.get_db(), supplement = std::move(supplement), worker_count,
+	        raw_blocks = std::move(raw_blocks), res = std::move(res)](http::ResponseData &response) mutable {
+		    BlockChain::DB::Reader reader(db);
+		    for (size_t i = 0; i != worker_count; ++i) {
+			    if (!BlockChain::read_header(reader, supplement[i], res.blocks[i].header))
+				    throw std::logic_error("Block header must be there, but it is not there");
+			    if (!BlockChain::read_block(reader, supplement[i], raw_blocks[i]))
+				    throw std::logic_error("Block must be there, but it is not there");
+			    if (!BlockChainState::read_block_output_global_indices(
+			            reader, supplement[i], res.blocks[i].global_indices))
+				    throw std::logic_error("Invariant dead - bid is in chain but blockchain has no block indices");
+		    }
+		    decode_sync_blocks(raw_blocks, res);
+		    set_api_response_body(json, id, res, response);
+	    });
+	return false;
+}
+
+bool Node::on_wallet_sync_raw3(http::Client *who, http::RequestData &&raw_request, json_rpc::Request &&,
+    api::jetcashd::SyncBlocksRaw::Request &&req, api::jetcashd::SyncBlocksRaw::Response &res) {
+	Height start_block_index = 0;
+	std::vector<Hash> supplement;
+	if (!get_wallet_sync_supplement(req, start_block_index, supplement))
+		return true;
+	res.start_height = start_block_index;
+	res.blocks.resize(supplement.size());
+	const size_t worker_count = get_worker_read_count(start_block_index, supplement.size());
+	for (size_t i = worker_count; i != supplement.size(); ++i) {
+		auto bhash = supplement[i];
+		if (!m_block_chain.read_header(bhash, res.blocks[i].header))
+			throw std::logic_error("Block header must be there, but it is not there");
+		if (!m_block_chain.read_block_data(bhash, res.blocks[i].raw_block))
+			throw std::logic_error("Block must be there, but it is not there");
+		if (!m_block_chain.read_block_output_global_indices_data(bhash, res.blocks[i].raw_global_indices))
+			throw std::logic_error(
+			    "Invariant dead - bid is in chain but "
+			    "blockchain has no block indices");
+	}
+	res.status = create_status_response3();
+	if (m_api_workers.empty())
+		return true;
+	m_api_workers.add_work(who, raw_request, false, json_rpc::OptionalJsonValue{},
+	    [&db = m_block_chain.get_db(), supplement = std::move(supplement), worker_count, res = std::move(res)](
+	        http::ResponseData &response) mutable {
+		    BlockChain::DB::Reader reader(db);
+		    for (size_t i = 0; i != worker_count; ++i) {
+			    if (!BlockChain::read_header(reader, supplement[i], res.blocks[i].header))
+				    throw std::logic_error("Block header must be there, but it is not there");
+			    if (!BlockChain::read_block_data(reader, supplement[i], res.blocks[i].raw_block))
+				    throw std::logic_error("Block must be there, but it is not there");
+			    if (!BlockChainState::read_block_output_global_indices_data(
+			            reader, supplement[i], res.blocks[i].raw_global_indices))
+				    throw std::logic_error("Invariant dead - bid is in chain but blockchain has no block indices");
+		    }
+		    set_api_response_body(false, json_rpc::OptionalJsonValue{}, res, response);
+	    });
+	return false;
+}
+
+size_t Node::get_worker_read_count(Height start_height, size_t count) const {
+	if (m_api_workers.empty())
+		return 0;
+	const Height committed_size = m_block_chain.get_committed_chain_size();
+	return committed_size > start_height ? std::min<size_t>(count, committed_size - start_height) : 0;
 }
 
 bool Node::on_sync_mempool3(http::Client *, http::RequestData &&, json_rpc::Request &&,
@@ -585,7 +1012,7 @@ bool Node::on_sync_mempool3(http::Client *, http::RequestData &&, json_rpc::Requ
 	for (auto &&tx : pool)
 		if (!std::binary_search(req.known_hashes.begin(), req.known_hashes.end(), tx.first)) {
 			//res.added_binary_transactions.push_back(seria::to_binary(tx.second));
-			res.added_bc_transactions.push_back(tx.second);
+			res.added_bc_transactions.push_back(tx.second.tx);
 			res.added_transactions.push_back(api::Transaction{});
 			res.added_transactions.back().hash      = tx.first;
 			res.added_transactions.back().timestamp = m_block_chain.read_first_seen_timestamp(tx.first);
@@ -605,7 +1032,7 @@ bool Node::handle_send_transaction3(http::Client *, http::RequestData &&, json_r
 	}
 	msg.txs.push_back(request.binary_transaction);
 	BinaryArray raw_msg = LevinProtocol::send_message(NOTIFY_NEW_TRANSACTIONS::ID, LevinProtocol::encode(msg), false);
-	m_p2p.broadcast(nullptr, raw_msg);
+	m_p2p.broadcast(nullptr, std::move(raw_msg));
 	response.send_result = "broadcast";  // Success
 	advance_long_poll();
 	return true;
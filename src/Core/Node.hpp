@@ -41,10 +41,16 @@ public:
 	// binary method
 	bool on_wallet_sync3(http::Client *, http::RequestData &&, json_rpc::Request &&,
 	    api::jetcashd::SyncBlocks::Request &&, api::jetcashd::SyncBlocks::Response &);
+	bool on_wallet_sync_raw3(http::Client *, http::RequestData &&, json_rpc::Request &&,
+	    api::jetcashd::SyncBlocksRaw::Request &&, api::jetcashd::SyncBlocksRaw::Response &);
 	bool on_sync_mempool3(http::Client *, http::RequestData &&, json_rpc::Request &&,
 	    api::jetcashd::SyncMemPool::Request &&, api::jetcashd::SyncMemPool::Response &);
 
 	api::jetcashd::GetStatus::Response create_status_response3() const;
+	bool get_wallet_sync_supplement(const api::jetcashd::SyncBlocks::Request &, Height &start_block_index,
+	    std::vector<Hash> &supplement) const;  // false if request is invalid
+	// Supplement prefix of this size was committed, so is read by API worker from DB snapshot, not on main thread
+	size_t get_worker_read_count(Height start_height, size_t count) const;
 	// json_rpc_node
 	bool on_get_status3(http::Client *, http::RequestData &&, json_rpc::Request &&,
 	    api::jetcashd::GetStatus::Request &&, api::jetcashd::GetStatus::Response &);
@@ -78,6 +84,44 @@ protected:
 	// We read from both because any could be truncated/corrupted
 	std::unique_ptr<LegacyBlockChainReader> m_block_chain_reader1;
 	std::unique_ptr<LegacyBlockChainReader> m_block_chain_reader2;
+
+	// Heavy read-only calls (DB reads, block decoding and response serialization for sync_blocks) are finished on
+	// these threads, so that they do not stall p2p. Workers read DB snapshot of last commit with DB::Reader, blocks
+	// added after last commit are still read on main thread
+	class APIWorkers {
+	public:
+		// Job must not touch Node or BlockChainState, except reading DB with DB::Reader
+		typedef std::function<void(http::ResponseData &)> Job;
+
+		explicit APIWorkers(size_t thread_count);
+		~APIWorkers();
+		bool empty() const { return threads.empty(); }
+		// If job throws, json request gets json-rpc error, binary request gets status 500
+		void add_work(http::Client *who, const http::RequestData &original_request, bool json,
+		    const json_rpc::OptionalJsonValue &json_id, Job &&job);
+		void on_disconnect(http::Client *who);
+		void on_idle();  // writes finished responses
+
+	private:
+		struct Work {
+			http::Client *who = nullptr;  // nullptr if disconnected while working
+			http::ResponseData response;
+			bool json = false;
+			json_rpc::OptionalJsonValue json_id;
+			Job job;
+			bool ready = false;
+		};
+		std::vector<std::thread> threads;
+		std::mutex mu;
+		std::condition_variable have_work;
+		std::list<Work> works;  // only main thread adds and erases
+		std::deque<Work *> work_queue;
+		platform::EventLoop *main_loop = nullptr;
+		bool quit                      = false;
+		void thread_run();
+		static void set_error(Work &wo, const json_rpc::Error &err);
+	};
+	APIWorkers m_api_workers;  // before m_api, so outlives disconnect handlers
 	std::unique_ptr<http::Server> m_api;
 	std::unique_ptr<platform::PreventSleep> m_prevent_sleep;
 	struct LongPollClient {
@@ -94,9 +138,11 @@ protected:
 	PeerDB m_peer_db;
 	P2P m_p2p;
 	platform::Timer m_commit_timer;
+	Height m_commit_height = 0;  // tip height at last commit, for --db-commit-blocks
 	std::unique_ptr<platform::PreventSleep> prevent_sleep;
 	void db_commit() {
 		m_block_chain.db_commit();
+		m_commit_height = m_block_chain.get_tip_height();
 		m_commit_timer.once(DB_COMMIT_PERIOD_JETCASHD);
 	}
 
@@ -107,6 +153,16 @@ protected:
 	class P2PClientJetcash : public P2PClientBasic {
 		Node *const m_node;
 
+		struct CompactBlock {  // waiting for missing transactions
+			NOTIFY_NEW_BLOCK::request req;  // missing transactions are empty
+			std::vector<Hash> transaction_hashes;
+			std::vector<uint32_t> missing_indexes;
+		};
+		enum { MAX_COMPACT_BLOCKS = 4 };  // per peer, usually there is only one
+		std::map<Hash, CompactBlock> m_compact_blocks;
+		std::deque<Hash> m_compact_blocks_order;  // oldest first, for eviction
+		void add_new_block(const Hash &bid, NOTIFY_NEW_BLOCK::request &&req);
+
 	protected:
 		virtual void on_disconnect(const std::string &ban_reason) override;
 
@@ -126,6 +182,9 @@ protected:
 		virtual void on_msg_timed_sync(COMMAND_TIMED_SYNC::response &&) override;
 		virtual void on_msg_notify_new_block(NOTIFY_NEW_BLOCK::request &&) override;
 		virtual void on_msg_notify_new_transactions(NOTIFY_NEW_TRANSACTIONS::request &&) override;
+		virtual void on_msg_notify_new_compact_block(NOTIFY_NEW_COMPACT_BLOCK::request &&) override;
+		virtual void on_msg_notify_block_transactions(NOTIFY_REQUEST_BLOCK_TRANSACTIONS::request &&) override;
+		virtual void on_msg_notify_block_transactions(NOTIFY_RESPONSE_BLOCK_TRANSACTIONS::request &&) override;
 #if jetcash_ALLOW_DEBUG_COMMANDS
 		virtual void on_msg_network_state(COMMAND_REQUEST_NETWORK_STATE::request &&) override;
 		virtual void on_msg_stat_info(COMMAND_REQUEST_STAT_INFO::request &&) override;
@@ -145,7 +204,19 @@ protected:
 
 		std::map<P2PClientJetcash *, size_t> m_good_clients;  // -> # of downloading blocks
 		size_t total_downloading_blocks = 0;
+		struct ClientStats {  // measured on NOTIFY_RESPONSE_GET_OBJECTS, sizes requests to that client
+			std::chrono::steady_clock::time_point last_response_time;
+			double min_rtt_seconds  = 0;  // 0 until first response
+			double bytes_per_second = 0;  // delivery rate while client has requests in flight
+		};
+		std::map<P2PClientJetcash *, ClientStats> m_client_stats;
+		double m_average_block_size = 0;  // of downloaded raw blocks, 0 until first one
+		size_t get_block_size_estimate() const;
+		size_t get_download_window() const;  // max m_download_chain size
+		size_t get_download_blocks() const;  // max total_downloading_blocks
+		size_t get_request_blocks(P2PClientJetcash *who) const;  // consecutive blocks in one request
 		std::list<P2PClientJetcash *> m_who_downloaded_block;
+		std::map<P2PClientJetcash *, size_t> m_who_downloaded_counter;  // kept in sync with m_who_downloaded_block
 		P2PClientJetcash *m_chain_client = nullptr;
 		platform::Timer m_chain_timer;  // If m_chain_client does not respond for long, disconnect it
 
@@ -163,6 +234,12 @@ protected:
 		std::deque<DownloadCell>
 		    m_download_chain;  // ~20-1000 of blocks we wish to have downloading (depending on current median size)
 		                       //		Height m_protected_start = 0;
+		uint64_t m_download_chain_start = 0;  // position of m_download_chain.front(), positions never reused
+		std::unordered_map<Hash, uint64_t> m_download_cell_positions;  // first cell with that bid
+		uint64_t m_first_unrequested = 0;  // cells before this position were all requested at some point
+		DownloadCell *find_download_cell(const Hash &bid, DownloadCell::Status status, P2PClientJetcash *who);
+		void push_download_cell(const Hash &bid, Height expected_height);
+		DownloadCell pop_download_cell();
 		Height m_chain_start_height = 0;
 		std::deque<Hash> m_chain;     // 10k-20k of hashes of the next wanted blocks
 		NetworkAddress chain_source;  // for banning culprit in case of a problem
@@ -203,6 +280,40 @@ protected:
 
 	DownloaderV11 m_downloader;
 
+	// Blocks from NOTIFY_NEW_BLOCK are prepared (decoding, PoW hash) on separate thread, so that p2p and API
+	// are not stalled. Prepared blocks are added to blockchain in order of arrival from on_idle
+	class NewBlockPreparator {
+	public:
+		NewBlockPreparator();
+		~NewBlockPreparator();
+		bool add_work(P2PClientJetcash *who, const Hash &bid, bool calculate_pow,
+		    NOTIFY_NEW_BLOCK::request &&req);  // false if full
+		void on_disconnect(P2PClientJetcash *who);
+		bool get_prepared(P2PClientJetcash *&who, NOTIFY_NEW_BLOCK::request &req, PreparedBlock &pb);
+
+	private:
+		enum { MAX_WORKS = 32 };  // peers are not throttled by socket reads while we prepare, so we limit queue
+		struct Work {
+			P2PClientJetcash *who = nullptr;  // nullptr if disconnected while preparing
+			Hash bid;
+			bool calculate_pow = true;  // false if PoW hash is stored in DB
+			NOTIFY_NEW_BLOCK::request req;
+			PreparedBlock pb;
+		};
+		std::thread thread;
+		std::mutex mu;
+		std::condition_variable have_work;
+		std::deque<Work> works;       // prepared ones at front
+		size_t prepared_counter = 0;  // only thread prepares, so in order
+		platform::EventLoop *main_loop = nullptr;
+		bool quit                      = false;
+		void thread_run();
+	};
+	NewBlockPreparator m_new_block_preparator;
+	void add_new_blocks();
+	void broadcast_new_block(P2PClientJetcash *exclude_who, const NOTIFY_NEW_BLOCK::request &req);
+	// NOTIFY_NEW_COMPACT_BLOCK to P2PProtocolVersion::V2 peers, NOTIFY_NEW_BLOCK to others
+
 	bool on_api_http_request(http::Client *, http::RequestData &&, http::ResponseData &);
 	void on_api_http_disconnect(http::Client *);
 
@@ -177,8 +177,7 @@ bool Node::on_submitblock(http::Client *, http::RequestData &&, json_rpc::Reques
 	msg.b                         = RawBlockLegacy{raw_block.block, raw_block.transactions};
 	msg.hop                       = 1;
 	msg.current_blockchain_height = m_block_chain.get_tip_height() + 1;  // TODO check
-	BinaryArray raw_msg = LevinProtocol::send_message(NOTIFY_NEW_BLOCK::ID, LevinProtocol::encode(msg), false);
-	m_p2p.broadcast(nullptr, raw_msg);
+	broadcast_new_block(nullptr, msg);
 	advance_long_poll();
 	res.status = CORE_RPC_STATUS_OK;
 	return true;
@@ -11,6 +11,14 @@ using namespace jetcash;
 
 static const bool multicore = true;
 
+// Window is limited by memory for downloaded, but not yet added blocks
+static const size_t DOWNLOAD_MEMORY_BUDGET = 256 * 1024 * 1024;
+static const size_t MIN_DOWNLOAD_WINDOW    = 200;
+static const size_t MAX_DOWNLOAD_WINDOW    = 10000;
+static const size_t MAX_REQUEST_BLOCKS     = 20;  // in single NOTIFY_REQUEST_GET_OBJECTS
+static const size_t MAX_REQUEST_BYTES      = 4 * 1024 * 1024;
+static const double CLIENT_STATS_SMOOTHING = 0.25;
+
 Node::DownloaderV11::DownloaderV11(Node *node, BlockChainState &block_chain)
     : m_node(node)
     , m_block_chain(block_chain)
@@ -47,9 +55,9 @@ void Node::DownloaderV11::add_work(std::tuple<Hash, bool, RawBlock> &&wo) {
 }
 
 void Node::DownloaderV11::thread_run() {
-	crypto::CryptoNightContext hash_crypto_context;
+	crypto::CryptoNightContext hash_crypto_context(2);
 	while (true) {
-		std::tuple<Hash, bool, RawBlock> wo;
+		std::vector<std::tuple<Hash, bool, RawBlock>> wos;
 		{
 			std::unique_lock<std::mutex> lock(mu);
 			if (quit)
@@ -58,13 +66,34 @@ void Node::DownloaderV11::thread_run() {
 				have_work.wait(lock);
 				continue;
 			}
-			wo = std::move(work.front());
-			work.pop_front();
+			// 2 blocks are hashed at once if possible, interleaved slow hash has much better throughput
+			while (!work.empty() && wos.size() < 2) {
+				wos.push_back(std::move(work.front()));
+				work.pop_front();
+			}
+		}
+		std::vector<PreparedBlock> results;
+		std::vector<BinaryArray> hashing_data;
+		std::vector<PreparedBlock *> to_hash;
+		results.reserve(wos.size());  // to_hash points into results
+		for (auto &&wo : wos) {
+			results.emplace_back(std::move(std::get<2>(wo)), nullptr);
+			if (std::get<1>(wo)) {
+				hashing_data.push_back(get_block_long_hashing_data(results.back().block.header));
+				to_hash.push_back(&results.back());
+			}
 		}
-		PreparedBlock result(std::move(std::get<2>(wo)), std::get<1>(wo) ? &hash_crypto_context : nullptr);
+		if (to_hash.size() == 2)
+			hash_crypto_context.cn_slow_hash2(hashing_data.at(0).data(), hashing_data.at(0).size(),
+			    hashing_data.at(1).data(), hashing_data.at(1).size(), to_hash.at(0)->long_block_hash,
+			    to_hash.at(1)->long_block_hash);
+		else if (to_hash.size() == 1)
+			to_hash.at(0)->long_block_hash =
+			    hash_crypto_context.cn_slow_hash(hashing_data.at(0).data(), hashing_data.at(0).size());
 		{
 			std::unique_lock<std::mutex> lock(mu);
-			prepared_blocks[std::get<0>(wo)] = std::move(result);
+			for (size_t i = 0; i != wos.size(); ++i)
+				prepared_blocks[std::get<0>(wos.at(i))] = std::move(results.at(i));
 			main_loop->wake();  // so we start processing on_idle
 		}
 	}
@@ -80,8 +109,9 @@ void Node::DownloaderV11::on_connect(P2PClientJetcash *who) {
 	if (who->is_incoming())  // Never sync from incoming
 		return;
 	m_node->m_log(logging::TRACE) << "DownloaderV11::on_connect " << who->get_address() << std::endl;
-	if (who->get_version() == 1) {
+	if (who->get_version() >= P2PProtocolVersion::V1) {
 		m_good_clients.insert(std::make_pair(who, 0));
+		m_client_stats[who] = ClientStats{};
 		if (who->get_last_received_sync_data().top_id == m_block_chain.get_tip_bid()) {
 			m_node->m_log(logging::TRACE) << "DownloaderV11::on_connect sync_transactions to " << who->get_address() << std::endl;
 			who->get_node()->sync_transactions(who);
@@ -99,15 +129,19 @@ void Node::DownloaderV11::on_disconnect(P2PClientJetcash *who) {
 		throw std::logic_error("total_downloading_blocks mismatch in disconnect");
 	total_downloading_blocks -= m_good_clients[who];
 	m_good_clients.erase(who);
+	m_client_stats.erase(who);
 	for (auto lit = m_who_downloaded_block.begin(); lit != m_who_downloaded_block.end();)
 		if (*lit == who)
 			lit = m_who_downloaded_block.erase(lit);
 		else
 			++lit;
-	for (auto &&dc : m_download_chain) {
+	m_who_downloaded_counter.erase(who);
+	for (size_t i = 0; i != m_download_chain.size(); ++i) {
+		auto &dc = m_download_chain.at(i);
 		if (dc.status != DownloadCell::DOWNLOADING || dc.downloading_client != who)
 			continue;
 		dc.downloading_client = nullptr;
+		m_first_unrequested   = std::min(m_first_unrequested, m_download_chain_start + i);
 	}
 	if (m_chain_client && m_chain_client == who) {
  		m_chain_timer.cancel();
@@ -136,11 +170,8 @@ void Node::DownloaderV11::on_msg_notify_request_chain(P2PClientJetcash *who,
 	chain_source         = m_chain_client->get_address();
 	m_chain.assign(req.m_block_ids.begin(), req.m_block_ids.end());
 	Hash last_downloaded_block = m_chain.empty() ? Hash{} : m_chain.back();
-	std::set<Hash> downloading_bids;
-	for (auto &&dc : m_download_chain)
-		downloading_bids.insert(dc.bid);
-	while (!m_chain.empty() &&
-	       (m_node->m_block_chain.has_block(m_chain.front()) || downloading_bids.count(m_chain.front()) != 0)) {
+	while (!m_chain.empty() && (m_node->m_block_chain.has_block(m_chain.front()) ||
+	                               m_download_cell_positions.count(m_chain.front()) != 0)) {
 		m_chain.pop_front();
 		m_chain_start_height += 1;
 	}  // We stop removing as soon as we find new block, because wrong order might
@@ -225,6 +256,8 @@ void Node::DownloaderV11::on_msg_timed_sync(const CORE_SYNC_DATA &payload_data)
 
 void Node::DownloaderV11::on_msg_notify_request_objects(P2PClientJetcash *who,
     const NOTIFY_RESPONSE_GET_OBJECTS::request &req) {
+	size_t response_bytes = 0;
+	std::chrono::steady_clock::time_point request_time;  // of the first block we asked, all in batch share it
 	for (auto &&rb : req.blocks) {
 		Hash bid;
 		try {
@@ -238,11 +271,19 @@ void Node::DownloaderV11::on_msg_notify_request_objects(P2PClientJetcash *who,
 			break;
 		}
 		bool cell_found = false;
-		for (auto &&dc : m_download_chain) {
-			if (dc.status != DownloadCell::DOWNLOADING || dc.downloading_client != who || dc.bid != bid)
-				continue;  // downloaded or downloading
+		if (DownloadCell *pdc = find_download_cell(bid, DownloadCell::DOWNLOADING, who)) {
+			DownloadCell &dc      = *pdc;
 			dc.status             = DownloadCell::DOWNLOADED;
 			dc.downloading_client = nullptr;
+			if (response_bytes == 0)
+				request_time = dc.request_time;
+			size_t block_size = rb.block.size();
+			for (auto &&tx : rb.transactions)
+				block_size += tx.size();
+			response_bytes += block_size;
+			m_average_block_size = m_average_block_size == 0
+			                           ? block_size
+			                           : m_average_block_size + (block_size - m_average_block_size) / 64;
 			dc.rb.block           = rb.block;         // TODO - std::move
 			dc.rb.transactions    = rb.transactions;  // TODO - std::move
 			auto git              = m_good_clients.find(who);
@@ -251,6 +292,7 @@ void Node::DownloaderV11::on_msg_notify_request_objects(P2PClientJetcash *who,
 			git->second -= 1;
 			total_downloading_blocks -= 1;
 			m_who_downloaded_block.push_back(who);
+			m_who_downloaded_counter[who] += 1;
 			auto now = std::chrono::steady_clock::now();
 			if (std::chrono::duration_cast<std::chrono::milliseconds>(now - log_response_timestamp).count() > 1000) {
 				log_response_timestamp = now;
@@ -262,42 +304,88 @@ void Node::DownloaderV11::on_msg_notify_request_objects(P2PClientJetcash *who,
 			cell_found = true;
 			if (multicore) {
 				dc.status = DownloadCell::PREPARING;
-				add_work(std::tuple<Hash, bool, RawBlock>(dc.bid,
-				    !m_node->m_block_chain.get_currency().is_in_checkpoint_zone(dc.expected_height), std::move(dc.rb)));
+				Hash long_hash;  // known blocks are never hashed again, check_standalone_consensus reads stored hash
+				const bool calculate_pow =
+				    !m_node->m_block_chain.get_currency().is_in_checkpoint_zone(dc.expected_height) &&
+				    !m_node->m_block_chain.read_long_hash(dc.bid, long_hash);
+				add_work(std::tuple<Hash, bool, RawBlock>(dc.bid, calculate_pow, std::move(dc.rb)));
 			} else {
 				dc.pb     = PreparedBlock(std::move(dc.rb), nullptr);
 				dc.status = DownloadCell::PREPARED;
 			}
-			break;
 		}
 		if (!cell_found) {
 			std::cout << "Received stray block from " << who->get_address() << " banning..." << std::endl;
 			m_node->m_log(logging::TRACE) << "DownloaderV11::on_msg_notify_request_objects received stray block from " << who->get_address() << " banning..." << std::endl;
 			who->disconnect(std::string());
-			break;
+			return;  // disconnect erased stats and called advance_download
 		}
 	}
+	auto sit = m_client_stats.find(who);
+	if (response_bytes != 0 && sit != m_client_stats.end()) {
+		ClientStats &stats = sit->second;
+		const auto now     = std::chrono::steady_clock::now();
+		const double rtt   = std::chrono::duration<double>(now - request_time).count();
+		// When requests are pipelined, client was busy with us since previous response
+		const double busy = std::chrono::duration<double>(now - std::max(stats.last_response_time, request_time)).count();
+		const double rate = response_bytes / std::max(busy, 0.001);
+		stats.min_rtt_seconds  = stats.min_rtt_seconds == 0 ? rtt : std::min(stats.min_rtt_seconds, rtt);
+		stats.bytes_per_second = stats.bytes_per_second == 0
+		                             ? rate
+		                             : stats.bytes_per_second + (rate - stats.bytes_per_second) * CLIENT_STATS_SMOOTHING;
+		stats.last_response_time = now;
+	}
 	advance_download(Hash{});
 }
 
+Node::DownloaderV11::DownloadCell *Node::DownloaderV11::find_download_cell(
+    const Hash &bid, DownloadCell::Status status, P2PClientJetcash *who) {
+	auto pit = m_download_cell_positions.find(bid);
+	if (pit == m_download_cell_positions.end())
+		return nullptr;
+	DownloadCell &dc = m_download_chain.at(pit->second - m_download_chain_start);
+	if (dc.status == status && (status != DownloadCell::DOWNLOADING || dc.downloading_client == who))
+		return &dc;
+	for (auto &&dc2 : m_download_chain)  // Only when chain contains duplicate bids, never in practice
+		if (dc2.bid == bid && dc2.status == status &&
+		    (status != DownloadCell::DOWNLOADING || dc2.downloading_client == who))
+			return &dc2;
+	return nullptr;
+}
+
+void Node::DownloaderV11::push_download_cell(const Hash &bid, Height expected_height) {
+	m_download_cell_positions.insert(std::make_pair(bid, m_download_chain_start + m_download_chain.size()));
+	m_download_chain.push_back(DownloadCell());
+	m_download_chain.back().bid             = bid;
+	m_download_chain.back().expected_height = expected_height;
+	m_download_chain.back().bid_source      = chain_source;
+}
+
+Node::DownloaderV11::DownloadCell Node::DownloaderV11::pop_download_cell() {
+	DownloadCell dc = std::move(m_download_chain.front());
+	m_download_chain.pop_front();
+	auto pit = m_download_cell_positions.find(dc.bid);
+	if (pit != m_download_cell_positions.end() && pit->second == m_download_chain_start)
+		m_download_cell_positions.erase(pit);
+	m_download_chain_start += 1;
+	return dc;
+}
+
 bool Node::DownloaderV11::on_idle() {
 	int added_counter = 0;
 	if (multicore) {
 		std::unique_lock<std::mutex> lock(mu);
 		for (auto &&pb : prepared_blocks) {
-			for (auto &&dc : m_download_chain)
-				if (dc.status == DownloadCell::PREPARING && dc.bid == pb.first) {
-					dc.pb     = std::move(pb.second);
-					dc.status = DownloadCell::PREPARED;
-					break;
-				}
+			if (DownloadCell *dc = find_download_cell(pb.first, DownloadCell::PREPARING, nullptr)) {
+				dc->pb     = std::move(pb.second);
+				dc->status = DownloadCell::PREPARED;
+			}
 		}
 		prepared_blocks.clear();
 	}
 	auto idea_start = std::chrono::high_resolution_clock::now();
 	while (!m_download_chain.empty() && m_download_chain.front().status == DownloadCell::PREPARED) {
-		DownloadCell dc = std::move(m_download_chain.front());
-		m_download_chain.pop_front();
+		DownloadCell dc = pop_download_cell();
 		api::BlockHeader info;
 		if (m_block_chain.add_block(dc.pb, info) == BroadcastAction::BAN) {
 			std::cout << "DownloadCell BAN height=" << dc.expected_height << " wb=" << common::pod_to_hex(dc.bid)
@@ -344,39 +432,67 @@ void Node::DownloaderV11::on_download_timer() {
 	}
 }
 
+size_t Node::DownloaderV11::get_block_size_estimate() const {
+	if (m_average_block_size != 0)
+		return std::max<size_t>(1024, static_cast<size_t>(m_average_block_size));
+	return m_block_chain.get_next_effective_median_size();  // Until we download some
+}
+
+size_t Node::DownloaderV11::get_download_window() const {
+	return std::max(MIN_DOWNLOAD_WINDOW,
+	    std::min(MAX_DOWNLOAD_WINDOW, DOWNLOAD_MEMORY_BUDGET / get_block_size_estimate()));
+}
+
+size_t Node::DownloaderV11::get_download_blocks() const { return get_download_window() / 5; }
+
+size_t Node::DownloaderV11::get_request_blocks(P2PClientJetcash *who) const {
+	auto sit = m_client_stats.find(who);
+	if (sit == m_client_stats.end() || sit->second.min_rtt_seconds == 0)
+		return 1;  // Probe new clients with single blocks
+	// Enough blocks to keep link busy for a round trip, so high-latency links are not idle between requests
+	const size_t block_size = get_block_size_estimate();
+	const size_t bdp_blocks =
+	    static_cast<size_t>(sit->second.bytes_per_second * sit->second.min_rtt_seconds / block_size);
+	return std::max<size_t>(1, std::min(std::min(MAX_REQUEST_BLOCKS, MAX_REQUEST_BYTES / block_size), bdp_blocks));
+}
+
 void Node::DownloaderV11::advance_download(Hash last_downloaded_block) {
 	if (m_node->m_block_chain_reader1 || m_node->m_block_chain_reader2 ||
 	    m_block_chain.get_tip_height() < m_block_chain.internal_import_known_height())
 		return;
-	const size_t TOTAL_DOWNLOAD_BLOCKS = 400;   // TODO - dynamic count
-	const size_t TOTAL_DOWNLOAD_WINDOW = 2000;  // TODO - dynamic count
+	const size_t TOTAL_DOWNLOAD_WINDOW = get_download_window();
+	const size_t TOTAL_DOWNLOAD_BLOCKS = get_download_blocks();
 	while (m_download_chain.size() < TOTAL_DOWNLOAD_WINDOW && !m_chain.empty()) {
-		m_download_chain.push_back(DownloadCell());
-		m_download_chain.back().bid             = m_chain.front();
-		m_download_chain.back().expected_height = m_chain_start_height;
-		m_download_chain.back().bid_source      = chain_source;
+		push_download_cell(m_chain.front(), m_chain_start_height);
 		m_chain.pop_front();
 		m_chain_start_height += 1;
 	}
 	advance_chain();
 
-	while (m_who_downloaded_block.size() > TOTAL_DOWNLOAD_BLOCKS)
+	while (m_who_downloaded_block.size() > TOTAL_DOWNLOAD_BLOCKS) {
+		auto cit = m_who_downloaded_counter.find(m_who_downloaded_block.front());
+		if (cit != m_who_downloaded_counter.end() && --cit->second == 0)
+			m_who_downloaded_counter.erase(cit);
 		m_who_downloaded_block.pop_front();
-	std::map<P2PClientJetcash *, size_t> who_downloaded_counter;
-	for (auto lit = m_who_downloaded_block.begin(); lit != m_who_downloaded_block.end(); ++lit)
-		who_downloaded_counter[*lit] += 1;
+	}
 	auto idea_now = std::chrono::steady_clock::now();
-	for (auto &&dc : m_download_chain) {
+	// Start from first cell not yet requested, so that cost does not grow with window
+	size_t first_unrequested = m_download_chain.size();
+	for (size_t i = std::max(m_download_chain_start, m_first_unrequested) - m_download_chain_start;
+	     i < m_download_chain.size(); ++i) {
+		const auto &dc = m_download_chain.at(i);
 		if (dc.status != DownloadCell::DOWNLOADING || dc.downloading_client)
 			continue;  // downloaded or downloading
+		first_unrequested = std::min(first_unrequested, i);
 		if (total_downloading_blocks >= TOTAL_DOWNLOAD_BLOCKS)
 			break;
 		P2PClientJetcash *ready_client = nullptr;
 		size_t ready_counter            = std::numeric_limits<size_t>::max();
 		size_t ready_speed              = 1;
 		for (auto &&who : m_good_clients) {
-			size_t speed =
-			    std::max<size_t>(1, std::min<size_t>(TOTAL_DOWNLOAD_BLOCKS / 4, who_downloaded_counter[who.first]));
+			auto cit     = m_who_downloaded_counter.find(who.first);
+			size_t speed = std::max<size_t>(1, std::min<size_t>(TOTAL_DOWNLOAD_BLOCKS / 4,
+			                                       cit == m_who_downloaded_counter.end() ? 0 : cit->second));
 			// We clamp speed so that if even 1 downloaded all blocks, we will give
 			// small % of blocks to other peers
 			if (who.second * ready_speed < ready_counter * speed &&
@@ -388,24 +504,36 @@ void Node::DownloaderV11::advance_download(Hash last_downloaded_block) {
 		}
 		if (!ready_client)
 			continue;  // Bad situation... Can be fixed only in new p2p protocol
-		dc.downloading_client = ready_client;
-		dc.request_time       = std::chrono::steady_clock::now();
-		m_good_clients[ready_client] += 1;
-		total_downloading_blocks += 1;
 		NOTIFY_REQUEST_GET_OBJECTS::request msg;
-		msg.blocks.push_back(dc.bid);
-//		auto now = std::chrono::steady_clock::now();
+		const size_t request_blocks = get_request_blocks(ready_client);
+		const auto request_time     = std::chrono::steady_clock::now();
+		for (size_t j = i; j != m_download_chain.size() && msg.blocks.size() < request_blocks &&
+		                   total_downloading_blocks < TOTAL_DOWNLOAD_BLOCKS;
+		     ++j) {  // consecutive blocks client has
+			auto &bc = m_download_chain.at(j);
+			if (bc.status != DownloadCell::DOWNLOADING || bc.downloading_client ||
+			    ready_client->get_last_received_sync_data().current_height < bc.expected_height)
+				break;
+			bc.downloading_client = ready_client;
+			bc.request_time       = request_time;
+			m_good_clients[ready_client] += 1;
+			total_downloading_blocks += 1;
+			msg.blocks.push_back(bc.bid);
+		}
+		if (first_unrequested == i)
+			first_unrequested = m_download_chain.size();  // will be set again by next unrequested cell
 		if (std::chrono::duration_cast<std::chrono::milliseconds>(idea_now - log_request_timestamp).count() > 1000) {
 			log_request_timestamp = idea_now;
-			std::cout << "Requesting block " << dc.expected_height << " from " << ready_client->get_address()
-			          << std::endl;
+			std::cout << "Requesting block " << dc.expected_height << " (count=" << msg.blocks.size() << ") from "
+			          << ready_client->get_address() << std::endl;
 		}
-		m_node->m_log(logging::TRACE) << "DownloaderV11::advance_download requesting block " << dc.expected_height << " hash=" << common::pod_to_hex(dc.bid) << " from " << ready_client->get_address()
+		m_node->m_log(logging::TRACE) << "DownloaderV11::advance_download requesting block " << dc.expected_height << " hash=" << common::pod_to_hex(dc.bid) << " count=" << msg.blocks.size() << " from " << ready_client->get_address()
 				  << std::endl;
 		BinaryArray raw_msg =
 		    LevinProtocol::send_message(NOTIFY_REQUEST_GET_OBJECTS::ID, LevinProtocol::encode(msg), false);
 		ready_client->send(std::move(raw_msg));
 	}
+	m_first_unrequested = m_download_chain_start + first_unrequested;
 	const bool bad_timeout = !m_download_chain.empty() && m_download_chain.front().status == DownloadCell::DOWNLOADING &&
 	    m_download_chain.front().downloading_client && !m_download_chain.front().protect_from_disconnect &&
 	    std::chrono::duration_cast<std::chrono::seconds>(idea_now - m_download_chain.front().request_time).count() >
@@ -77,15 +77,62 @@ PreparedWalletTransaction::PreparedWalletTransaction(TransactionPrefix &&ttx, co
 		++out_index;
 	}
 }
+// Same result as PreparedWalletTransaction constructor for each transaction, but derivations and spend keys
+// of the whole block are calculated with batch crypto functions
+static void prepare_wallet_transactions(
+    const std::vector<PreparedWalletTransaction *> &ptxs, const SecretKey &view_secret_key) {
+	std::vector<PublicKey> tx_public_keys;
+	tx_public_keys.reserve(ptxs.size());
+	for (auto &&ptx : ptxs)
+		tx_public_keys.push_back(get_transaction_public_key_from_extra(ptx->tx.extra));
+	std::vector<KeyDerivation> derivations(ptxs.size());
+	generate_key_derivations(tx_public_keys.data(), tx_public_keys.size(), view_secret_key, derivations.data());
+
+	std::vector<KeyDerivation> output_derivations;
+	std::vector<size_t> output_indices;
+	std::vector<PublicKey> output_keys;
+	for (size_t i = 0; i != ptxs.size(); ++i) {
+		if (derivations.at(i) == KeyDerivation{})
+			continue;
+		ptxs.at(i)->derivation = derivations.at(i);
+		size_t key_index       = 0;
+		for (const auto &output : ptxs.at(i)->tx.outputs) {
+			if (output.target.type() == typeid(KeyOutput)) {
+				const KeyOutput &key_output = boost::get<KeyOutput>(output.target);
+				output_derivations.push_back(derivations.at(i));
+				output_indices.push_back(key_index);
+				output_keys.push_back(key_output.key);
+				++key_index;
+			}
+		}
+	}
+	std::vector<PublicKey> spend_keys(output_keys.size());  // error indicated by spend_key == PublicKey{}
+	underive_public_keys(output_derivations.data(), output_indices.data(), output_keys.data(), output_keys.size(),
+	    spend_keys.data());
+
+	size_t pos = 0;
+	for (size_t i = 0; i != ptxs.size(); ++i) {
+		if (derivations.at(i) == KeyDerivation{})
+			continue;
+		auto &keys = ptxs.at(i)->spend_keys;
+		for (const auto &output : ptxs.at(i)->tx.outputs)
+			if (output.target.type() == typeid(KeyOutput))
+				keys.push_back(spend_keys.at(pos++));
+	}
+}
+
 PreparedWalletBlock::PreparedWalletBlock(BlockTemplate &&bc_header, std::vector<TransactionPrefix> &&bc_transactions,
     Hash base_transaction_hash, const SecretKey &view_secret_key)
     : base_transaction_hash(base_transaction_hash) {
-	header           = bc_header;
-	base_transaction = PreparedWalletTransaction(std::move(bc_header.base_transaction), view_secret_key);
-	transactions.reserve(bc_transactions.size());
+	header              = bc_header;
+	base_transaction.tx = std::move(bc_header.base_transaction);
+	transactions.resize(bc_transactions.size());
+	std::vector<PreparedWalletTransaction *> ptxs{&base_transaction};
 	for (size_t tx_index = 0; tx_index != bc_transactions.size(); ++tx_index) {
-		transactions.emplace_back(std::move(bc_transactions.at(tx_index)), view_secret_key);
+		transactions.at(tx_index).tx = std::move(bc_transactions.at(tx_index));
+		ptxs.push_back(&transactions.at(tx_index));
 	}
+	prepare_wallet_transactions(ptxs, view_secret_key);
 }
 
 void WalletPreparatorMulticore::thread_run() {
@@ -94,24 +141,57 @@ void WalletPreparatorMulticore::thread_run() {
 		Height height          = 0;
 		int local_work_counter = 0;
 		api::jetcashd::SyncBlocks::SyncBlock sync_block;
-		std::vector<std::vector<uint32_t>> global_indices;
+		api::jetcashd::SyncBlocksRaw::RawSyncBlock raw_sync_block;
+		bool is_raw = false;
 		{
 			std::unique_lock<std::mutex> lock(mu);
 			if (quit)
 				return;
-			if (work.blocks.empty()) {
+			if (work.blocks.empty() && raw_work.blocks.empty()) {
 				have_work.wait(lock);
 				continue;
 			}
 			local_work_counter = work_counter;
 			view_secret_key    = work_secret_key;
-			height             = work.start_height;
-			sync_block         = std::move(work.blocks.front());
-			work.start_height += 1;
-			work.blocks.erase(work.blocks.begin());
+			is_raw             = work.blocks.empty();
+			if (is_raw) {
+				height         = raw_work.start_height;
+				raw_sync_block = std::move(raw_work.blocks.front());
+				raw_work.start_height += 1;
+				raw_work.blocks.erase(raw_work.blocks.begin());
+			} else {
+				height     = work.start_height;
+				sync_block = std::move(work.blocks.front());
+				work.start_height += 1;
+				work.blocks.erase(work.blocks.begin());
+			}
+		}
+		PreparedWalletBlock result;
+		if (is_raw) {
+			try {  // Leave result empty on error, wallet state will detect header mismatch
+				RawBlock rb;
+				Block block;
+				seria::from_binary(rb, raw_sync_block.raw_block);
+				if (block.from_raw_block(rb)) {
+					Hash base_transaction_hash = get_transaction_hash(block.header.base_transaction);
+					std::vector<TransactionPrefix> transactions;
+					transactions.reserve(block.transactions.size());
+					for (auto &&tx : block.transactions)
+						transactions.push_back(std::move(tx));
+					result = PreparedWalletBlock(
+					    std::move(block.header), std::move(transactions), base_transaction_hash, view_secret_key);
+					seria::from_binary(result.global_indices, raw_sync_block.raw_global_indices);
+					result.bid = get_block_hash(result.header);
+				}
+			} catch (const std::exception &) {
+				result = PreparedWalletBlock();
+			}
+		} else {
+			result = PreparedWalletBlock(std::move(sync_block.bc_header), std::move(sync_block.bc_transactions),
+			    sync_block.base_transaction_hash, view_secret_key);
+			result.global_indices = std::move(sync_block.global_indices);
+			result.bid            = sync_block.header.hash;
 		}
-		PreparedWalletBlock result(std::move(sync_block.bc_header), std::move(sync_block.bc_transactions),
-		    sync_block.base_transaction_hash, view_secret_key);
 		{
 			std::unique_lock<std::mutex> lock(mu);
 			if (local_work_counter == work_counter) {
@@ -124,7 +204,8 @@ void WalletPreparatorMulticore::thread_run() {
 
 void WalletPreparatorMulticore::cancel_work() {
 	std::unique_lock<std::mutex> lock(mu);
-	work = api::jetcashd::SyncBlocks::Response();
+	work     = api::jetcashd::SyncBlocks::Response();
+	raw_work = api::jetcashd::SyncBlocksRaw::Response();
 	prepared_blocks.clear();
 	work_counter += 1;
 }
@@ -133,6 +214,17 @@ void WalletPreparatorMulticore::start_work(const api::jetcashd::SyncBlocks::Resp
     const SecretKey &view_secret_key) {
 	std::unique_lock<std::mutex> lock(mu);
 	work            = new_work;
+	raw_work        = api::jetcashd::SyncBlocksRaw::Response();
+	work_secret_key = view_secret_key;
+	work_counter += 1;
+	have_work.notify_all();
+}
+
+void WalletPreparatorMulticore::start_work(
+    const api::jetcashd::SyncBlocksRaw::Response &new_work, const SecretKey &view_secret_key) {
+	std::unique_lock<std::mutex> lock(mu);
+	work            = api::jetcashd::SyncBlocks::Response();
+	raw_work        = new_work;
 	work_secret_key = view_secret_key;
 	work_counter += 1;
 	have_work.notify_all();
@@ -267,6 +359,7 @@ WalletState::WalletState(Wallet &wallet, logging::ILogger &log, const Config &co
           0x2000000000)  // 128 gb
     , log_redo_block(std::chrono::steady_clock::now())
     , m_memory_state(0, 0) {
+	m_db.set_background_sync(config.db_background_sync);
 	std::string version;
 	m_db.get("$version", version);
 	if (version != version_current) {
@@ -355,6 +448,17 @@ std::vector<WalletRecord> WalletState::generate_new_addresses(const std::vector<
 }
 
 bool WalletState::sync_with_blockchain(api::jetcashd::SyncBlocks::Response &resp) {
+	bool bad_block = false;
+	return sync_blocks_with_blockchain(resp, bad_block);
+}
+
+bool WalletState::sync_with_blockchain(api::jetcashd::SyncBlocksRaw::Response &resp, bool &bad_raw_block) {
+	return sync_blocks_with_blockchain(resp, bad_raw_block);
+}
+
+template<class SyncResponse>
+bool WalletState::sync_blocks_with_blockchain(SyncResponse &resp, bool &bad_block) {
+	bad_block = false;
 	if (resp.blocks.empty())  // Our creation timestamp > last block timestamp, so
 		                      // no blocks
 		return true;
@@ -393,10 +497,13 @@ bool WalletState::sync_with_blockchain(api::jetcashd::SyncBlocks::Response &resp
 		if (m_tip_height + 1 != m_tail_height && header.previous_block_hash != m_tip.hash)
 			return false;
 		if (header.timestamp + m_currency.block_future_time_limit >= m_wallet.get_oldest_timestamp()) {
-			const auto &block_gi = resp.blocks.at(bin).global_indices;
 			PreparedWalletBlock pb = preparator.get_ready_work(m_tip_height + 1);
+			if (pb.bid != header.hash) {
+				bad_block = true;  // Raw block failed to decode or does not match header
+				return false;
+			}
 			// PreparedWalletBlock pb(std::move(resp.blocks.at(bin).block), m_wallet.get_view_secret_key());
-			redo_block(header, pb, block_gi, m_tip_height + 1);
+			redo_block(header, pb, pb.global_indices, m_tip_height + 1);
 			// push_chain(header);
 			// undo_block(m_tip_height);
 			// pop_chain();
@@ -593,11 +700,12 @@ bool WalletState::parse_raw_transaction(api::Transaction &ptx, const Transaction
 			input_amount += in.amount;
 			ptx.fee += in.amount;
 			ptx.anonymity = std::min(ptx.anonymity, static_cast<uint32_t>(in.output_indexes.size() - 1));
-			auto key      = KEYIMAGE_PREFIX + to_binary_key(in.key_image);
-			BinaryArray rb;
-			if (m_db.get(key, rb)) {
+			platform::DBKey key(KEYIMAGE_PREFIX);
+			key.append_hex(&in.key_image, sizeof(in.key_image));
+			DB::Value rb;
+			if (m_db.get(key.view(), rb)) {
 				api::Output output;
-				seria::from_binary(output, rb);
+				seria::from_binary(output, rb.data(), rb.size());
 				
 				api::Transfer &transfer = transfer_map2[output.address];
 				transfer.amount -= static_cast<SignedAmount>(output.amount);
@@ -746,11 +854,12 @@ bool WalletState::redo_transaction(const PreparedWalletTransaction &pwtx, const
 			input_amount += in.amount;
 			ptx.fee += in.amount;
 			ptx.anonymity = std::min(ptx.anonymity, static_cast<uint32_t>(in.output_indexes.size()));
-			auto key      = KEYIMAGE_PREFIX + to_binary_key(in.key_image);
-			BinaryArray rb;
-			if (m_db.get(key, rb)) {
+			platform::DBKey key(KEYIMAGE_PREFIX);
+			key.append_hex(&in.key_image, sizeof(in.key_image));
+			DB::Value rb;
+			if (m_db.get(key.view(), rb)) {
 				api::Output output;
-				seria::from_binary(output, rb);
+				seria::from_binary(output, rb.data(), rb.size());
 
 				api::Transfer &transfer = transfer_map2[output.address];
 				transfer.amount -= static_cast<SignedAmount>(output.amount);
@@ -1225,12 +1334,13 @@ std::vector<api::Block> WalletState::api_get_transfers(
 }
 
 bool WalletState::api_get_transaction(Hash tid, TransactionPrefix &tx, api::Transaction &ptx) const {
-	auto trkey = TRANSACTION_PREFIX + to_binary_key(tid);
-	BinaryArray data;
-	if (!m_db.get(trkey, data))
+	platform::DBKey trkey(TRANSACTION_PREFIX);
+	trkey.append_hex(&tid, sizeof(tid));
+	DB::Value data;
+	if (!m_db.get(trkey.view(), data))
 		return false;
 	std::pair<TransactionPrefix, api::Transaction> pa;
-	seria::from_binary(pa, data);
+	seria::from_binary(pa, data.data(), data.size());
 	tx  = std::move(pa.first);
 	ptx = std::move(pa.second);
 	return true;
@@ -47,6 +47,8 @@ struct PreparedWalletBlock {
 	PreparedWalletTransaction base_transaction;
 	Hash base_transaction_hash;
 	std::vector<PreparedWalletTransaction> transactions;
+	BlockChainState::BlockGlobalIndices global_indices;
+	Hash bid;  // of decoded header, zero if raw block failed to decode
 	PreparedWalletBlock() {}
 	PreparedWalletBlock(BlockTemplate &&bc_header, std::vector<TransactionPrefix> &&bc_transactions,
 	    Hash base_transaction_hash, const SecretKey &view_secret_key);
@@ -61,6 +63,7 @@ class WalletPreparatorMulticore {
 
 	std::map<Height, PreparedWalletBlock> prepared_blocks;
 	api::jetcashd::SyncBlocks::Response work;
+	api::jetcashd::SyncBlocksRaw::Response raw_work;  // decoded by preparator threads
 	int work_counter = 0;
 	SecretKey work_secret_key;
 	void thread_run();
@@ -70,6 +73,7 @@ public:
 	~WalletPreparatorMulticore();
 	void cancel_work();
 	void start_work(const api::jetcashd::SyncBlocks::Response &new_work, const SecretKey &view_secret_key);
+	void start_work(const api::jetcashd::SyncBlocksRaw::Response &new_work, const SecretKey &view_secret_key);
 	PreparedWalletBlock get_ready_work(Height height);
 };
 
@@ -122,6 +126,8 @@ public:
 
 	std::vector<Hash> get_sparse_chain() const;
 	bool sync_with_blockchain(api::jetcashd::SyncBlocks::Response &);  // We move from it
+	// bad_raw_block is set if raw block failed to decode or does not match header, batch should be requested decoded
+	bool sync_with_blockchain(api::jetcashd::SyncBlocksRaw::Response &, bool &bad_raw_block);
 	bool sync_with_blockchain(api::jetcashd::SyncMemPool::Response &);
 	void add_transient_transaction(const Hash &tid, const TransactionPrefix &tx);
 
@@ -201,6 +207,8 @@ private:
 	uint32_t m_tx_pool_version = 1;
 	std::chrono::steady_clock::time_point log_redo_block;
 
+	template<class SyncResponse>
+	bool sync_blocks_with_blockchain(SyncResponse &resp, bool &bad_block);  // common part for decoded and raw
 	bool read_tips();
 	void push_chain(const api::BlockHeader &);
 	bool read_chain(Height, api::BlockHeader &) const;
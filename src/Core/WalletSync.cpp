@@ -5,6 +5,7 @@
 #include "Config.hpp"
 #include "CryptoNoteTools.hpp"
 #include "TransactionBuilder.hpp"
+#include "common/Ipv4Address.hpp"
 #include "seria/BinaryInputStream.hpp"
 #include "seria/BinaryOutputStream.hpp"
 #include "seria/KVBinaryInputStream.hpp"
@@ -15,6 +16,17 @@ constexpr float STATUS_ERROR_PERIOD = 5;
 
 using namespace jetcash;
 
+// Raw blocks are decoded by walletd, this pays off only when jetcashd is on the same machine
+static bool is_loopback_host(std::string host) {
+	const std::string prefix = "https://";
+	if (host.find(prefix) == 0)
+		host = host.substr(prefix.size());
+	if (host == "localhost" || host == "::1" || host == "[::1]")
+		return true;
+	uint32_t ip = 0;
+	return common::parse_ip_address(host, ip) && host.find("127.") == 0;
+}
+
 WalletSync::WalletSync(
     logging::ILogger &log, const Config &config, WalletState &wallet_state, std::function<void()> state_changed_handler)
     : m_state_changed_handler(state_changed_handler)
@@ -27,7 +39,8 @@ WalletSync::WalletSync(
     , m_commands_agent(config.jetcashd_remote_ip,
           config.jetcashd_remote_port ? config.jetcashd_remote_port : config.jetcashd_bind_port)
     , m_wallet_state(wallet_state)
-    , m_commit_timer(std::bind(&WalletSync::db_commit, this)) {
+    , m_commit_timer(std::bind(&WalletSync::db_commit, this))
+    , m_use_raw_blocks(is_loopback_host(config.jetcashd_remote_ip)) {
 	advance_sync();
 	m_commit_timer.once(DB_COMMIT_PERIOD_WALLET_CACHE);
 }
@@ -88,7 +101,10 @@ void WalletSync::advance_sync() {
 		return;
 	}
 	if (m_last_node_status.top_block_hash != m_wallet_state.get_tip_bid()) {
-		send_get_blocks();
+		if (m_use_raw_blocks)
+			send_get_blocks_raw();
+		else
+			send_get_blocks();
 		return;
 	}
 	if (transient_transactions_counter == 0)
@@ -153,3 +169,42 @@ void WalletSync::send_get_blocks() {
 		});
 	//	m_log(logging::INFO) << "WalletNode::send_get_blocks" << std::endl;
 }
+
+void WalletSync::send_get_blocks_raw() {
+	api::jetcashd::SyncBlocksRaw::Request msg;
+	msg.sparse_chain          = m_wallet_state.get_sparse_chain();
+	msg.first_block_timestamp = m_wallet_state.get_wallet().get_oldest_timestamp();
+	http::RequestData req_header;
+	req_header.r.set_firstline("POST", api::jetcashd::SyncBlocksRaw::bin_method(), 1, 1);
+	req_header.r.basic_authorization = m_config.jetcashd_authorization;
+	req_header.set_body(seria::to_binary_str(msg));
+	m_sync_request = std::make_unique<http::Request>(m_sync_agent, std::move(req_header),
+	    [&](http::ResponseData &&response) {
+		    m_sync_request.reset();
+		    if (response.r.status == 404) {  // Older jetcashd, fall back to decoded blocks
+			    m_use_raw_blocks = false;
+			    advance_sync();
+			    return;
+		    }
+		    api::jetcashd::SyncBlocksRaw::Response resp;
+		    seria::from_binary(resp, response.body);
+		    m_last_node_status = resp.status;
+		    m_sync_error       = "WRONG_BLOCKCHAIN";
+		    bool bad_raw_block = false;
+		    if (m_wallet_state.sync_with_blockchain(resp, bad_raw_block)) {
+			    m_sync_error = std::string();
+			    advance_sync();
+		    } else if (bad_raw_block) {  // same batch decoded by jetcashd, next batches are raw again
+			    m_log(logging::WARNING) << "Raw block failed to decode, requesting decoded blocks" << std::endl;
+			    m_sync_error = std::string();
+			    send_get_blocks();
+		    } else
+			    m_status_timer.once(STATUS_ERROR_PERIOD);
+		    m_state_changed_handler();
+		},
+	    [&](std::string err) {
+		    m_sync_error = "CONNECTION_FAILED";
+		    m_status_timer.once(STATUS_ERROR_PERIOD);
+		    m_state_changed_handler();
+		});
+}
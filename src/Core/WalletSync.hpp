@@ -43,6 +43,8 @@ protected:
 	void send_get_status();
 	void send_sync_pool();
 	void send_get_blocks();
+	bool m_use_raw_blocks;  // jetcashd on the same host sends blocks as stored, we decode them on preparator threads
+	void send_get_blocks_raw();
 };
 
 }  // namespace jetcash
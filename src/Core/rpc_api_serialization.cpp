@@ -419,6 +419,16 @@ void ser_members(api::jetcashd::SyncBlocks::Response &v, ISeria &s) {
 	seria_kv("start_height", v.start_height, s);
 	seria_kv("status", v.status, s);
 }
+void ser_members(jetcash::api::jetcashd::SyncBlocksRaw::RawSyncBlock &v, ISeria &s) {
+	seria_kv("header", v.header, s);
+	seria_kv("raw_block", v.raw_block, s);
+	seria_kv("raw_global_indices", v.raw_global_indices, s);
+}
+void ser_members(api::jetcashd::SyncBlocksRaw::Response &v, ISeria &s) {
+	seria_kv("blocks", v.blocks, s);
+	seria_kv("start_height", v.start_height, s);
+	seria_kv("status", v.status, s);
+}
 void ser_members(api::jetcashd::SyncMemPool::Request &v, ISeria &s) {
 	if (!s.is_input())
 		std::sort(v.known_hashes.begin(), v.known_hashes.end());
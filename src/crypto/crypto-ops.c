@@ -8,6 +8,14 @@
 #include "crypto-ops-data.h"
 #include "crypto-util.h"
 
+/* 64-bit platforms multiply field elements as 5 limbs of 51 bits with 128-bit products. Elements are
+   stored in ref10 form everywhere else, so tables, bounds and results are exactly as with ref10 code */
+#if defined(__SIZEOF_INT128__) && !defined(crypto_FE_REF10)
+#define FE_RADIX51 1
+#else
+#define FE_RADIX51 0
+#endif
+
 /* Predeclarations */
 
 static void fe_mul(fe, const fe, const fe);
@@ -348,6 +356,7 @@ Can get away with 11 carries, but then data flow is much deeper.
 With tighter constraints on inputs can squeeze carries into int32.
 */
 
+#if !FE_RADIX51
 static void fe_mul(fe h, const fe f, const fe g) {
   int32_t f0 = f[0];
   int32_t f1 = f[1];
@@ -565,6 +574,7 @@ static void fe_mul(fe h, const fe f, const fe g) {
   h[8] = (int32_t) h8;
   h[9] = (int32_t) h9;
 }
+#endif
 
 /* From fe_neg.c */
 
@@ -628,6 +638,7 @@ Postconditions:
 See fe_mul.c for discussion of implementation strategy.
 */
 
+#if !FE_RADIX51
 static void fe_sq(fe h, const fe f) {
   int32_t f0 = f[0];
   int32_t f1 = f[1];
@@ -758,6 +769,7 @@ static void fe_sq(fe h, const fe f) {
   h[8] = (int32_t) h8;
   h[9] = (int32_t) h9;
 }
+#endif
 
 /* From fe_sq2.c */
 
@@ -776,6 +788,7 @@ Postconditions:
 See fe_mul.c for discussion of implementation strategy.
 */
 
+#if !FE_RADIX51
 static void fe_sq2(fe h, const fe f) {
   int32_t f0 = f[0];
   int32_t f1 = f[1];
@@ -917,6 +930,96 @@ static void fe_sq2(fe h, const fe f) {
   h[8] = (int32_t) h8;
   h[9] = (int32_t) h9;
 }
+#endif
+
+#if FE_RADIX51
+
+/* Limbs 2i and 2i+1 of ref10 form (26 and 25 bits, signed) are joined into one signed 51-bit limb.
+   With fe_mul input bounds limbs are below 1.65*2^51, so sum of 5 products multiplied by 19 fits
+   easily into int128 */
+
+typedef __int128 fe51_wide;
+
+static inline void fe51_load(int64_t r[5], const fe f) {
+  int i;
+  for (i = 0; i < 5; i++) {
+    r[i] = (int64_t) f[2 * i] + (int64_t) f[2 * i + 1] * ((int64_t) 1 << 26);
+  }
+}
+
+/* Carries products into limbs below 2^51, then splits each limb into centered 26 and 25 bit halves,
+   giving the same output bounds as ref10 fe_mul */
+static inline void fe51_store(fe h, fe51_wide r0, fe51_wide r1, fe51_wide r2, fe51_wide r3, fe51_wide r4) {
+  const int64_t mask51 = ((int64_t) 1 << 51) - 1;
+  int64_t s[5], v, lo, hi, carry = 0;
+  int i;
+
+  r1 += r0 >> 51; s[0] = (int64_t) r0 & mask51;
+  r2 += r1 >> 51; s[1] = (int64_t) r1 & mask51;
+  r3 += r2 >> 51; s[2] = (int64_t) r2 & mask51;
+  r4 += r3 >> 51; s[3] = (int64_t) r3 & mask51;
+  s[0] += (int64_t) (r4 >> 51) * 19; s[4] = (int64_t) r4 & mask51;
+  s[1] += s[0] >> 51; s[0] &= mask51;
+
+  for (i = 0; i < 5; i++) {
+    v = s[i] + carry;
+    lo = ((v + ((int64_t) 1 << 25)) & (((int64_t) 1 << 26) - 1)) - ((int64_t) 1 << 25);
+    v = (v - lo) >> 26;
+    hi = ((v + ((int64_t) 1 << 24)) & (((int64_t) 1 << 25) - 1)) - ((int64_t) 1 << 24);
+    carry = (v - hi) >> 25;
+    h[2 * i] = (int32_t) lo;
+    h[2 * i + 1] = (int32_t) hi;
+  }
+  /* carry is -1, 0 or 1, so h[0] stays within ref10 bounds */
+  h[0] += (int32_t) carry * 19;
+}
+
+static void fe_mul(fe h, const fe f, const fe g) {
+  int64_t a[5], b[5];
+  fe51_load(a, f);
+  fe51_load(b, g);
+  {
+    const int64_t b1_19 = 19 * b[1], b2_19 = 19 * b[2], b3_19 = 19 * b[3], b4_19 = 19 * b[4];
+    const fe51_wide r0 = (fe51_wide) a[0] * b[0] + (fe51_wide) a[1] * b4_19 + (fe51_wide) a[2] * b3_19 +
+                         (fe51_wide) a[3] * b2_19 + (fe51_wide) a[4] * b1_19;
+    const fe51_wide r1 = (fe51_wide) a[0] * b[1] + (fe51_wide) a[1] * b[0] + (fe51_wide) a[2] * b4_19 +
+                         (fe51_wide) a[3] * b3_19 + (fe51_wide) a[4] * b2_19;
+    const fe51_wide r2 = (fe51_wide) a[0] * b[2] + (fe51_wide) a[1] * b[1] + (fe51_wide) a[2] * b[0] +
+                         (fe51_wide) a[3] * b4_19 + (fe51_wide) a[4] * b3_19;
+    const fe51_wide r3 = (fe51_wide) a[0] * b[3] + (fe51_wide) a[1] * b[2] + (fe51_wide) a[2] * b[1] +
+                         (fe51_wide) a[3] * b[0] + (fe51_wide) a[4] * b4_19;
+    const fe51_wide r4 = (fe51_wide) a[0] * b[4] + (fe51_wide) a[1] * b[3] + (fe51_wide) a[2] * b[2] +
+                         (fe51_wide) a[3] * b[1] + (fe51_wide) a[4] * b[0];
+    fe51_store(h, r0, r1, r2, r3, r4);
+  }
+}
+
+static inline void fe51_sq(fe h, const fe f, int times2) {
+  int64_t a[5];
+  fe51_load(a, f);
+  {
+    const int64_t a0_2 = 2 * a[0], a1_2 = 2 * a[1], a3_19 = 19 * a[3], a4_19 = 19 * a[4];
+    fe51_wide r0 = (fe51_wide) a[0] * a[0] + (fe51_wide) a1_2 * a4_19 + (fe51_wide) (2 * a[2]) * a3_19;
+    fe51_wide r1 = (fe51_wide) a0_2 * a[1] + (fe51_wide) (2 * a[2]) * a4_19 + (fe51_wide) a[3] * a3_19;
+    fe51_wide r2 = (fe51_wide) a0_2 * a[2] + (fe51_wide) a[1] * a[1] + (fe51_wide) (2 * a[3]) * a4_19;
+    fe51_wide r3 = (fe51_wide) a0_2 * a[3] + (fe51_wide) a1_2 * a[2] + (fe51_wide) a[4] * a4_19;
+    fe51_wide r4 = (fe51_wide) a0_2 * a[4] + (fe51_wide) a1_2 * a[3] + (fe51_wide) a[2] * a[2];
+    if (times2) {
+      r0 *= 2; r1 *= 2; r2 *= 2; r3 *= 2; r4 *= 2;
+    }
+    fe51_store(h, r0, r1, r2, r3, r4);
+  }
+}
+
+static void fe_sq(fe h, const fe f) {
+  fe51_sq(h, f, 0);
+}
+
+static void fe_sq2(fe h, const fe f) {
+  fe51_sq(h, f, 1);
+}
+
+#endif
 
 /* From fe_sub.c */
 
@@ -1167,18 +1270,23 @@ B is the Ed25519 base point (x,4/5) with x positive.
 */
 
 void ge_double_scalarmult_base_vartime(ge_p2 *r, const struct EllipticCurveScalar *aa, const ge_p3 *A, const struct EllipticCurveScalar *bb) {
+  ge_dsmp Ai; /* A, 3A, 5A, 7A, 9A, 11A, 13A, 15A */
+
+  ge_dsm_precomp(Ai, A);
+  ge_double_scalarmult_base_precomp_vartime(r, aa, Ai, bb);
+}
+
+void ge_double_scalarmult_base_precomp_vartime(ge_p2 *r, const struct EllipticCurveScalar *aa, const ge_dsmp Ai, const struct EllipticCurveScalar *bb) {
 	const unsigned char * a = aa->data;
 	const unsigned char * b = bb->data;
   signed char aslide[256];
   signed char bslide[256];
-  ge_dsmp Ai; /* A, 3A, 5A, 7A, 9A, 11A, 13A, 15A */
   ge_p1p1 t;
   ge_p3 u;
   int i;
 
   slide(aslide, a);
   slide(bslide, b);
-  ge_dsm_precomp(Ai, A);
 
   ge_p2_0(r);
 
@@ -1597,6 +1705,36 @@ void ge_tobytes(struct EllipticCurvePoint *ss, const ge_p2 *h) {
   s[31] ^= fe_isnegative(x) << 7;
 }
 
+/* Montgomery's trick: Z values are multiplied together, product is inverted once and
+   each inverse is then peeled off with two multiplications */
+
+void ge_tobytes_batch(struct EllipticCurvePoint *ss, const ge_p2 *h, size_t count) {
+  enum { CHUNK = 64 }; /* keeps prefix products on stack */
+  fe acc[CHUNK];
+  fe recip, zinv, x, y;
+  size_t start, i, n;
+
+  for (start = 0; start < count; start += n) {
+    n = count - start < CHUNK ? count - start : CHUNK;
+    fe_copy(acc[0], h[start].Z);
+    for (i = 1; i < n; i++)
+      fe_mul(acc[i], acc[i - 1], h[start + i].Z);
+    fe_invert(recip, acc[n - 1]);
+    for (i = n; i-- > 0;) {
+      if (i == 0) {
+        fe_copy(zinv, recip);
+      } else {
+        fe_mul(zinv, recip, acc[i - 1]);
+        fe_mul(recip, recip, h[start + i].Z);
+      }
+      fe_mul(x, h[start + i].X, zinv);
+      fe_mul(y, h[start + i].Y, zinv);
+      fe_tobytes(ss[start + i].data, y);
+      ss[start + i].data[31] ^= fe_isnegative(x) << 7;
+    }
+  }
+}
+
 /* From sc_reduce.c */
 
 /*
@@ -1920,10 +2058,13 @@ static void ge_cached_cmov(ge_cached *t, const ge_cached *u, unsigned char b) {
 /* Assumes that a[31] <= 127 */
 void ge_scalarmult(ge_p2 *r, const struct EllipticCurveScalar *a, const ge_p3 *A) {
   signed char e[64];
+
+  ge_scalarmult_recode(e, a);
+  ge_scalarmult_recoded(r, e, A);
+}
+
+void ge_scalarmult_recode(signed char e[64], const struct EllipticCurveScalar *a) {
   int carry, carry2, i;
-  ge_cached Ai[8]; /* 1 * A, 2 * A, ..., 8 * A */
-  ge_p1p1 t;
-  ge_p3 u;
 
   carry = 0; /* 0..1 */
   for (i = 0; i < 31; i++) {
@@ -1937,6 +2078,13 @@ void ge_scalarmult(ge_p2 *r, const struct EllipticCurveScalar *a, const ge_p3 *A
   carry2 = (carry + 8) >> 4; /* 0..8 */
   e[62] = carry - (carry2 << 4); /* -8..7 */
   e[63] = carry2; /* 0..8 */
+}
+
+void ge_scalarmult_recoded(ge_p2 *r, const signed char e[64], const ge_p3 *A) {
+  int i;
+  ge_cached Ai[8]; /* 1 * A, 2 * A, ..., 8 * A */
+  ge_p1p1 t;
+  ge_p3 u;
 
   ge_p3_to_cached(&Ai[0], A);
   for (i = 0; i < 7; i++) {
@@ -1979,18 +2127,23 @@ void ge_scalarmult(ge_p2 *r, const struct EllipticCurveScalar *a, const ge_p3 *A
 }
 
 void ge_double_scalarmult_precomp_vartime(ge_p2 *r, const struct EllipticCurveScalar *aa, const ge_p3 *A, const struct EllipticCurveScalar *bb, const ge_dsmp Bi) {
+  ge_dsmp Ai; /* A, 3A, 5A, 7A, 9A, 11A, 13A, 15A */
+
+  ge_dsm_precomp(Ai, A);
+  ge_double_scalarmult_precomp2_vartime(r, aa, Ai, bb, Bi);
+}
+
+void ge_double_scalarmult_precomp2_vartime(ge_p2 *r, const struct EllipticCurveScalar *aa, const ge_dsmp Ai, const struct EllipticCurveScalar *bb, const ge_dsmp Bi) {
 	const unsigned char * a = aa->data;
 	const unsigned char * b = bb->data;
   signed char aslide[256];
   signed char bslide[256];
-  ge_dsmp Ai; /* A, 3A, 5A, 7A, 9A, 11A, 13A, 15A */
   ge_p1p1 t;
   ge_p3 u;
   int i;
 
   slide(aslide, a);
   slide(bslide, b);
-  ge_dsm_precomp(Ai, A);
 
   ge_p2_0(r);
 
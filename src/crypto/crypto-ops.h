@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <stddef.h>
 #include "c_types.h"
 #if defined(__cplusplus)
 namespace crypto { extern "C" {
@@ -56,6 +57,7 @@ void ge_add(ge_p1p1 *, const ge_p3 *, const ge_cached *);
 typedef ge_cached ge_dsmp[8];
 void ge_dsm_precomp(ge_dsmp r, const ge_p3 *s);
 void ge_double_scalarmult_base_vartime(ge_p2 *, const struct EllipticCurveScalar *, const ge_p3 *, const struct EllipticCurveScalar *);
+void ge_double_scalarmult_base_precomp_vartime(ge_p2 *, const struct EllipticCurveScalar *, const ge_dsmp, const struct EllipticCurveScalar *);
 
 /* From ge_frombytes.c, modified */
 
@@ -104,7 +106,13 @@ void sc_reduce(struct EllipticCurveScalar *, const unsigned char[64]);
 /* New code */
 
 void ge_scalarmult(ge_p2 *, const struct EllipticCurveScalar *, const ge_p3 *);
+/* Same as ge_scalarmult, with scalar recoded once for many points */
+void ge_scalarmult_recode(signed char[64], const struct EllipticCurveScalar *);
+void ge_scalarmult_recoded(ge_p2 *, const signed char[64], const ge_p3 *);
+/* Same as ge_tobytes for each point, with one field inversion for all of them */
+void ge_tobytes_batch(struct EllipticCurvePoint *, const ge_p2 *, size_t);
 void ge_double_scalarmult_precomp_vartime(ge_p2 *, const struct EllipticCurveScalar *, const ge_p3 *, const struct EllipticCurveScalar *, const ge_dsmp);
+void ge_double_scalarmult_precomp2_vartime(ge_p2 *, const struct EllipticCurveScalar *, const ge_dsmp, const struct EllipticCurveScalar *, const ge_dsmp);
 int ge_check_subgroup_precomp_vartime(const ge_dsmp);
 void ge_mul8(ge_p1p1 *, const ge_p2 *);
 void ge_fromfe_frombytes_vartime(ge_p2 *, const unsigned char[32]);
@@ -1,6 +1,7 @@
 // Copyright (c) 2018, The Jetcash Project.
 // Licensed under the GNU Lesser General Public License. See LICENSE for details.
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -8,6 +9,8 @@
 #include <cstring>
 #include <memory>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #include "crypto-ops.h"
 #include "crypto.hpp"
@@ -228,6 +231,63 @@ bool underive_public_key(const KeyDerivation &derivation, size_t output_index, c
 	return true;
 }
 
+void generate_key_derivations(
+    const PublicKey *keys, size_t count, const SecretKey &key2, KeyDerivation *derivations) {
+	signed char e[64];
+	assert(sc_isvalid_vartime(&key2));
+	ge_scalarmult_recode(e, &key2);
+	std::vector<ge_p2> points;
+	std::vector<size_t> indices;  // of valid keys
+	points.reserve(count);
+	indices.reserve(count);
+	for (size_t i = 0; i != count; ++i) {
+		ge_p3 point;
+		ge_p2 point2;
+		ge_p1p1 point3;
+		derivations[i] = KeyDerivation{};
+		if (ge_frombytes_vartime(&point, &keys[i]) != 0)
+			continue;
+		ge_scalarmult_recoded(&point2, e, &point);
+		ge_mul8(&point3, &point2);
+		points.emplace_back();
+		ge_p1p1_to_p2(&points.back(), &point3);
+		indices.push_back(i);
+	}
+	std::vector<EllipticCurvePoint> result(points.size());
+	ge_tobytes_batch(result.data(), points.data(), points.size());
+	for (size_t j = 0; j != indices.size(); ++j)
+		static_cast<EllipticCurvePoint &>(derivations[indices[j]]) = result[j];
+}
+
+void underive_public_keys(const KeyDerivation *derivations, const size_t *output_indices,
+    const PublicKey *derived_keys, size_t count, PublicKey *bases) {
+	std::vector<ge_p2> points;
+	std::vector<size_t> indices;  // of valid derived keys
+	points.reserve(count);
+	indices.reserve(count);
+	for (size_t i = 0; i != count; ++i) {
+		EllipticCurveScalar scalar;
+		ge_p3 point1;
+		ge_p3 point2;
+		ge_cached point3;
+		ge_p1p1 point4;
+		bases[i] = PublicKey{};
+		if (ge_frombytes_vartime(&point1, &derived_keys[i]) != 0)
+			continue;
+		derivation_to_scalar(derivations[i], output_indices[i], scalar);
+		ge_scalarmult_base(&point2, &scalar);
+		ge_p3_to_cached(&point3, &point2);
+		ge_sub(&point4, &point1, &point3);
+		points.emplace_back();
+		ge_p1p1_to_p2(&points.back(), &point4);
+		indices.push_back(i);
+	}
+	std::vector<EllipticCurvePoint> result(points.size());
+	ge_tobytes_batch(result.data(), points.data(), points.size());
+	for (size_t j = 0; j != indices.size(); ++j)
+		static_cast<EllipticCurvePoint &>(bases[indices[j]]) = result[j];
+}
+
 #pragma pack(push, 1)
 struct s_comm {
 	Hash h;
@@ -440,6 +500,74 @@ bool check_ring_signature(const Hash &prefix_hash, const KeyImage &image, const
 	return sc_iszero(&h);
 }
 
+namespace {
+struct PreparedRingKey {
+	bool valid = false;
+	ge_dsmp key_pre;     // of output key
+	ge_dsmp hashed_pre;  // of hash_to_ec(output key)
+};
+}  // anonymous namespace
+
+bool check_ring_signatures(RingSignatureCheck checks[], size_t count, bool check_key_image) {
+	std::unordered_map<PublicKey, PreparedRingKey> keys;
+	std::vector<unsigned char> buf_data;
+	for (size_t ch = 0; ch != count; ++ch) {
+		RingSignatureCheck &check = checks[ch];
+		check.result              = false;
+		check.key_corrupted       = false;
+		ge_p3 image_unp;
+		ge_dsmp image_pre;
+		EllipticCurveScalar sum, h;
+		const size_t buf_size = rs_comm_size(check.pubs_count);
+		buf_data.resize(std::max(buf_data.size(), buf_size));
+		rs_comm *const buf = reinterpret_cast<rs_comm *>(buf_data.data());
+		if (ge_frombytes_vartime(&image_unp, &check.image) != 0)
+			continue;
+		ge_dsm_precomp(image_pre, &image_unp);
+		if (check_key_image && ge_check_subgroup_precomp_vartime(image_pre) != 0)
+			continue;
+		sc_0(&sum);
+		buf->h = check.prefix_hash;
+		size_t i = 0;
+		for (; i < check.pubs_count; i++) {
+			ge_p2 tmp2;
+			const Signature &sig = check.sigs[i];
+			if (!sc_isvalid_vartime(&sig.c) || !sc_isvalid_vartime(&sig.r))
+				break;
+			auto kit = keys.find(*check.pubs[i]);
+			if (kit == keys.end()) {
+				kit = keys.emplace(*check.pubs[i], PreparedRingKey{}).first;
+				ge_p3 tmp3;
+				if (ge_frombytes_vartime(&tmp3, check.pubs[i]) == 0) {
+					kit->second.valid = true;
+					ge_dsm_precomp(kit->second.key_pre, &tmp3);
+					hash_to_ec(*check.pubs[i], tmp3);
+					ge_dsm_precomp(kit->second.hashed_pre, &tmp3);
+				}
+			}
+			if (!kit->second.valid) {
+				check.key_corrupted = true;
+				assert(false);
+				break;
+			}
+			ge_double_scalarmult_base_precomp_vartime(&tmp2, &sig.c, kit->second.key_pre, &sig.r);
+			ge_tobytes(&buf->ab[i].a, &tmp2);
+			ge_double_scalarmult_precomp2_vartime(&tmp2, &sig.r, kit->second.hashed_pre, &sig.c, image_pre);
+			ge_tobytes(&buf->ab[i].b, &tmp2);
+			sc_add(&sum, &sum, &sig.c);
+		}
+		if (i != check.pubs_count)
+			continue;
+		hash_to_scalar(buf, buf_size, h);
+		sc_sub(&h, &h, &sum);
+		check.result = sc_iszero(&h) != 0;
+	}
+	bool all_valid = true;
+	for (size_t ch = 0; ch != count; ++ch)
+		all_valid = all_valid && checks[ch].result;
+	return all_valid;
+}
+
 #pragma pack(push, 1)
 struct sp_comm {
 	Hash message_hash;
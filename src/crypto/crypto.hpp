@@ -82,6 +82,13 @@ bool underive_public_key(const KeyDerivation &derivation, size_t output_index, c
 bool underive_public_key(
     const KeyDerivation &derivation, size_t output_index, const PublicKey &derived_key, PublicKey &base);
 
+// Batch versions for wallet scanning, much faster than calls above in a loop. View key is recoded once and all
+// results share one field inversion. KeyDerivation{} and PublicKey{} mark invalid input keys
+void generate_key_derivations(
+    const PublicKey *keys, size_t count, const SecretKey &key2, KeyDerivation *derivations);
+void underive_public_keys(const KeyDerivation *derivations, const size_t *output_indices,
+    const PublicKey *derived_keys, size_t count, PublicKey *bases);
+
 // returns false if keys are corrupted/invalid
 void generate_signature(const Hash &prefix_hash, const PublicKey &pub, const SecretKey &sec, Signature &sig);
 bool check_signature(
@@ -102,6 +109,21 @@ bool generate_ring_signature(const Hash &prefix_hash, const KeyImage &image, con
     std::size_t pubs_count, const SecretKey &sec, std::size_t sec_index, Signature sigs[]);
 bool check_ring_signature(const Hash &prefix_hash, const KeyImage &image, const PublicKey *const pubs[],
     size_t pubs_count, const Signature sigs[], bool check_key_image, bool *key_corrupted = nullptr);
+
+// One item of check_ring_signatures batch, pointed to data must outlive the call
+struct RingSignatureCheck {
+	Hash prefix_hash;
+	KeyImage image;
+	const PublicKey *const *pubs = nullptr;
+	size_t pubs_count            = 0;
+	const Signature *sigs        = nullptr;
+	bool result                  = false;  // set by check_ring_signatures
+	bool key_corrupted           = false;  // set by check_ring_signatures
+};
+// Same result as check_ring_signature for each item, but each distinct output key is unpacked, hashed to
+// curve and precomputed only once per batch. Returns true if all signatures are valid
+bool check_ring_signatures(RingSignatureCheck checks[], size_t count, bool check_key_image);
+
 // TODO - remove one pair of funs
 // returns false if keys are corrupted/invalid
 inline bool generate_ring_signature(const Hash &prefix_hash, const KeyImage &image,
@@ -0,0 +1,184 @@
+// Copyright (c) 2018, The Jetcash Project.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "hash-impl.h"
+#include "keccak.h"
+
+#ifdef __APPLE__
+#include "TargetConditionals.h"
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)) && !TARGET_OS_IPHONE
+#define HASH_BATCH_AVX2 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define HASH_BATCH_TARGET_AVX2
+#else
+#define HASH_BATCH_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+extern const uint64_t keccakf_rndc[24];
+extern const int keccakf_rotc[24];
+extern const int keccakf_piln[24];
+
+static void cn_fast_hash_batch_scalar(
+    const void *const *data, const size_t *lengths, size_t count, unsigned char (*hashes)[HASH_SIZE]) {
+  size_t i;
+  for (i = 0; i < count; ++i)
+    cn_fast_hash(data[i], lengths[i], hashes[i]);
+}
+
+#if HASH_BATCH_AVX2
+
+enum { LANES = 4, RATE_WORDS = HASH_DATA_AREA / 8 };
+
+// Same permutation as keccakf, state word i of message k is in 64-bit lane k of st[i]
+HASH_BATCH_TARGET_AVX2 static void keccakf4(__m256i st[25]) {
+  int i, j, round;
+  __m256i t, bc[5];
+
+  for (round = 0; round < KECCAK_ROUNDS; round++) {
+    // Theta
+    for (i = 0; i < 5; i++)
+      bc[i] = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(st[i], st[i + 5]), _mm256_xor_si256(st[i + 10], st[i + 15])), st[i + 20]);
+    for (i = 0; i < 5; i++) {
+      __m256i b = bc[(i + 1) % 5];
+      t = _mm256_xor_si256(bc[(i + 4) % 5], _mm256_or_si256(_mm256_slli_epi64(b, 1), _mm256_srli_epi64(b, 63)));
+      for (j = 0; j < 25; j += 5)
+        st[j + i] = _mm256_xor_si256(st[j + i], t);
+    }
+
+    // Rho Pi
+    t = st[1];
+    for (i = 0; i < 24; i++) {
+      const __m128i left = _mm_cvtsi32_si128(keccakf_rotc[i]);
+      const __m128i right = _mm_cvtsi32_si128(64 - keccakf_rotc[i]);
+      j = keccakf_piln[i];
+      bc[0] = st[j];
+      st[j] = _mm256_or_si256(_mm256_sll_epi64(t, left), _mm256_srl_epi64(t, right));
+      t = bc[0];
+    }
+
+    //  Chi
+    for (j = 0; j < 25; j += 5) {
+      for (i = 0; i < 5; i++)
+        bc[i] = st[j + i];
+      for (i = 0; i < 5; i++)
+        st[j + i] = _mm256_xor_si256(st[j + i], _mm256_andnot_si256(bc[(i + 1) % 5], bc[(i + 2) % 5]));
+    }
+
+    //  Iota
+    st[0] = _mm256_xor_si256(st[0], _mm256_set1_epi64x((long long)keccakf_rndc[round]));
+  }
+}
+
+// Up to 4 messages of any lengths are absorbed in lockstep, lanes of shorter messages
+// take their output after their last block and then absorb zeroes until the longest finishes
+HASH_BATCH_TARGET_AVX2 static void cn_fast_hash_batch4(
+    const void *const *data, const size_t *lengths, size_t count, unsigned char (*hashes)[HASH_SIZE]) {
+  static const uint64_t zero_block[RATE_WORDS] = {0};
+  uint64_t last_blocks[LANES][RATE_WORDS];
+  const uint64_t *blocks[LANES];
+  size_t block_counts[LANES];
+  size_t max_blocks = 0, b, k;
+  __m256i st[25];
+  int i;
+
+  for (k = 0; k < LANES; ++k) {
+    const size_t length = k < count ? lengths[k] : 0;
+    const size_t rest = length % HASH_DATA_AREA;
+    unsigned char *temp = (unsigned char *)last_blocks[k];
+    block_counts[k] = length / HASH_DATA_AREA + 1;
+    if (block_counts[k] > max_blocks && k < count)
+      max_blocks = block_counts[k];
+    // last block and padding, exactly as in keccak
+    if (k < count)
+      memcpy(temp, (const unsigned char *)data[k] + length - rest, rest);
+    temp[rest] = 1;
+    memset(temp + rest + 1, 0, HASH_DATA_AREA - rest - 1);
+    temp[HASH_DATA_AREA - 1] |= 0x80;
+  }
+  for (i = 0; i < 25; i++)
+    st[i] = _mm256_setzero_si256();
+  for (b = 0; b < max_blocks; ++b) {
+    for (k = 0; k < LANES; ++k) {
+      if (k >= count || b >= block_counts[k])
+        blocks[k] = zero_block;
+      else if (b + 1 == block_counts[k])
+        blocks[k] = last_blocks[k];
+      else
+        blocks[k] = (const uint64_t *)((const unsigned char *)data[k] + b * HASH_DATA_AREA);
+    }
+    for (i = 0; i < RATE_WORDS; i++) {
+      uint64_t w[LANES];
+      for (k = 0; k < LANES; ++k)
+        memcpy(&w[k], blocks[k] + i, sizeof(uint64_t));  // input can be unaligned
+      st[i] = _mm256_xor_si256(st[i], _mm256_set_epi64x((long long)w[3], (long long)w[2], (long long)w[1], (long long)w[0]));
+    }
+    keccakf4(st);
+    for (k = 0; k < count; ++k) {
+      if (b + 1 == block_counts[k]) {
+        uint64_t words[HASH_SIZE / 8][LANES];
+        for (i = 0; i < HASH_SIZE / 8; i++)
+          _mm256_storeu_si256((__m256i *)words[i], st[i]);
+        for (i = 0; i < HASH_SIZE / 8; i++)
+          memcpy(hashes[k] + i * 8, &words[i][k], 8);
+      }
+    }
+  }
+}
+
+static void cn_fast_hash_batch_avx2(
+    const void *const *data, const size_t *lengths, size_t count, unsigned char (*hashes)[HASH_SIZE]) {
+  size_t i;
+  for (i = 0; i + 1 < count; i += LANES)
+    cn_fast_hash_batch4(data + i, lengths + i, count - i < LANES ? count - i : LANES, hashes + i);
+  if (i < count)
+    cn_fast_hash(data[i], lengths[i], hashes[i]);  // single message is faster with scalar code
+}
+
+static int cpu_has_avx2(void) {
+#if defined(_MSC_VER)
+  int cpuinfo[4];
+  __cpuid(cpuinfo, 1);
+  if ((cpuinfo[2] & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6)  // OS saves ymm registers
+    return 0;
+  __cpuidex(cpuinfo, 7, 0);
+  return (cpuinfo[1] & (1 << 5)) ? 1 : 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+
+static void cn_fast_hash_batch_runtime_check(
+    const void *const *data, const size_t *lengths, size_t count, unsigned char (*hashes)[HASH_SIZE]);
+
+static void (*cn_fast_hash_batch_fp)(const void *const *, const size_t *, size_t, unsigned char (*)[HASH_SIZE]) =
+    cn_fast_hash_batch_runtime_check;
+
+static void cn_fast_hash_batch_runtime_check(
+    const void *const *data, const size_t *lengths, size_t count, unsigned char (*hashes)[HASH_SIZE]) {
+  cn_fast_hash_batch_fp = cpu_has_avx2() ? cn_fast_hash_batch_avx2 : cn_fast_hash_batch_scalar;
+  cn_fast_hash_batch_fp(data, lengths, count, hashes);
+}
+
+void cn_fast_hash_batch(
+    const void *const *data, const size_t *lengths, size_t count, unsigned char (*hashes)[HASH_SIZE]) {
+  cn_fast_hash_batch_fp(data, lengths, count, hashes);
+}
+
+#else
+
+void cn_fast_hash_batch(
+    const void *const *data, const size_t *lengths, size_t count, unsigned char (*hashes)[HASH_SIZE]) {
+  cn_fast_hash_batch_scalar(data, lengths, count, hashes);
+}
+
+#endif
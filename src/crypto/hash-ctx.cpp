@@ -2,7 +2,9 @@
 // Licensed under the GNU Lesser General Public License. See LICENSE for details.
 
 #include <assert.h>
+#include <stdint.h>
 #include <new>
+#include <stdexcept>
 
 #include "hash.hpp"
 
@@ -14,12 +16,31 @@
 
 namespace crypto {
 
-enum { MAP_SIZE = SLOW_HASH_CONTEXT_SIZE + ((-SLOW_HASH_CONTEXT_SIZE) & 0xfff) };
+// Scratchpad is at the start of context and is accessed randomly, with 4K pages almost every access misses TLB.
+// With huge pages each lane starts on its own huge page, so that scratchpad is covered by exactly one of them
+enum {
+	MAP_SIZE       = SLOW_HASH_CONTEXT_SIZE + ((-SLOW_HASH_CONTEXT_SIZE) & 0xfff),
+	HUGE_PAGE_SIZE = 2 * 1024 * 1024,
+	HUGE_LANE_SIZE = (MAP_SIZE + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE
+};
 
 #if defined(_WIN32)
 
-CryptoNightContext::CryptoNightContext() {
-	data = VirtualAlloc(nullptr, MAP_SIZE, MEM_COMMIT, PAGE_READWRITE);
+CryptoNightContext::CryptoNightContext(size_t ways) : ways(ways), lane_size(MAP_SIZE), map_size(MAP_SIZE * ways) {
+	if (ways == 0)
+		throw std::logic_error("CryptoNightContext needs at least 1 way");
+	const SIZE_T large_page = GetLargePageMinimum();  // needs SeLockMemoryPrivilege, usually not granted
+	if (large_page != 0) {
+		const size_t large_lane = (MAP_SIZE + large_page - 1) / large_page * large_page;
+		data = VirtualAlloc(nullptr, large_lane * ways, MEM_COMMIT | MEM_RESERVE | MEM_LARGE_PAGES, PAGE_READWRITE);
+		if (data != nullptr) {
+			lane_size  = large_lane;
+			map_size   = large_lane * ways;
+			huge_pages = true;
+			return;
+		}
+	}
+	data = VirtualAlloc(nullptr, map_size, MEM_COMMIT, PAGE_READWRITE);
 	if (data == nullptr) {
 		throw std::bad_alloc();
 	}
@@ -32,22 +53,67 @@ CryptoNightContext::~CryptoNightContext() {
 
 #else
 
-CryptoNightContext::CryptoNightContext() {
+CryptoNightContext::CryptoNightContext(size_t ways) : ways(ways), lane_size(MAP_SIZE), map_size(MAP_SIZE * ways) {
+	if (ways == 0)
+		throw std::logic_error("CryptoNightContext needs at least 1 way");
+#if defined(MAP_HUGETLB)
+	// fails unless huge pages are reserved with vm.nr_hugepages, hugetlb pages are never swapped, so no mlock
+	data = mmap(nullptr, HUGE_LANE_SIZE * ways, PROT_READ | PROT_WRITE,
+	    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+	if (data != MAP_FAILED) {
+		lane_size  = HUGE_LANE_SIZE;
+		map_size   = HUGE_LANE_SIZE * ways;
+		huge_pages = true;
+		return;
+	}
+#endif
+#if defined(MADV_HUGEPAGE)
+	// Transparent huge pages need 2MiB aligned scratchpads, but mmap aligns only to 4K. We reserve one more huge
+	// page, then unmap misaligned head and tail. Slack between end of context and next lane is never touched
+	const size_t reserve_size = HUGE_LANE_SIZE * ways + HUGE_PAGE_SIZE;
+	void *reserved = mmap(nullptr, reserve_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (reserved == MAP_FAILED) {
+		throw std::bad_alloc();
+	}
+	const size_t head = (HUGE_PAGE_SIZE - reinterpret_cast<uintptr_t>(reserved) % HUGE_PAGE_SIZE) % HUGE_PAGE_SIZE;
+	lane_size         = HUGE_LANE_SIZE;
+	map_size          = HUGE_LANE_SIZE * ways;
+	data              = reinterpret_cast<char *>(reserved) + head;
+	if (head != 0)
+		munmap(reserved, head);
+	if (reserve_size - head - map_size != 0)
+		munmap(reinterpret_cast<char *>(data) + map_size, reserve_size - head - map_size);
+	for (size_t i = 0; i != ways; ++i) {
+		char *lane = reinterpret_cast<char *>(data) + lane_size * i;
+		// Only scratchpad is advised, so that small state after it does not fault in another huge page
+		madvise(lane, HUGE_PAGE_SIZE, MADV_HUGEPAGE);  // before first touch, otherwise kernel commits small pages
+		mlock(lane, MAP_SIZE);                         // also populates
+	}
+#else
 #if !defined(__APPLE__)
-	data = mmap(nullptr, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+	data = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
 #else
-	data = mmap(nullptr, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+	data = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
 #endif
 	if (data == MAP_FAILED) {
 		throw std::bad_alloc();
 	}
-	mlock(data, MAP_SIZE);
+	mlock(data, map_size);  // also populates
+#endif
 }
 
 CryptoNightContext::~CryptoNightContext() {
-	if (munmap(data, MAP_SIZE) != 0)
+	if (munmap(data, map_size) != 0)
 		assert(false);
 }
 
 #endif
+
+void CryptoNightContext::cn_slow_hash2(
+    const void *src_data1, size_t length1, const void *src_data2, size_t length2, Hash &hash1, Hash &hash2) {
+	if (ways < 2)
+		throw std::logic_error("CryptoNightContext::cn_slow_hash2 needs context with 2 ways");
+	crypto::cn_slow_hash2(data, reinterpret_cast<char *>(data) + lane_size, src_data1, length1, src_data2, length2,
+	    hash1.data, hash2.data);
+}
 }
@@ -16,13 +16,18 @@ inline Hash cn_fast_hash(const void *data, size_t length) {
 	cn_fast_hash(data, length, h.data);
 	return h;
 }
+inline void cn_fast_hash_batch(const void *const *data, const size_t *lengths, size_t count, Hash *hashes) {
+	cn_fast_hash_batch(data, lengths, count, reinterpret_cast<unsigned char(*)[HASH_SIZE]>(hashes));
+}
 //	inline Hash cn_fast_hash(const std::vector<uint8_t> & data) {
 //		return cn_fast_hash(data.data(), data.size());
 //	}
 
 class CryptoNightContext {
 public:
-	CryptoNightContext();
+	// ways > 1 allocates separate scratchpads for cn_slow_hash2. Scratchpads are placed on huge
+	// pages if OS gives them, otherwise on normal pages
+	explicit CryptoNightContext(size_t ways = 1);
 	~CryptoNightContext();
 
 	CryptoNightContext(const CryptoNightContext &) = delete;
@@ -36,9 +41,18 @@ public:
 		crypto::cn_slow_hash(data, src_data, length, hash.data);
 		return hash;
 	}
+	// Two independent hashes in about the time of one and a half
+	void cn_slow_hash2(const void *src_data1, size_t length1, const void *src_data2, size_t length2, Hash &hash1,
+	    Hash &hash2);
+	size_t get_ways() const { return ways; }
+	bool has_huge_pages() const { return huge_pages; }
 
 private:
 	void *data;
+	size_t ways;
+	size_t lane_size;  // distance between scratchpads, multiple of huge page size if we got huge pages
+	size_t map_size;
+	bool huge_pages = false;
 };
 
 inline Hash tree_hash(const Hash *hashes, size_t count) {
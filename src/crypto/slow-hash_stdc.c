@@ -155,4 +155,10 @@ static void cn_slow_hash_platform_independent(void * scratchpad, const void *dat
 void cn_slow_hash(void * scratchpad, const void *data, size_t length, void *hash) {
 	cn_slow_hash_platform_independent(scratchpad, data, length, hash);
 }
+
+void cn_slow_hash2(void *scratchpad1, void *scratchpad2, const void *data1, size_t length1, const void *data2,
+    size_t length2, void *hash1, void *hash2) {
+	cn_slow_hash_platform_independent(scratchpad1, data1, length1, hash1);
+	cn_slow_hash_platform_independent(scratchpad2, data2, length2, hash2);
+}
 #endif // TARGET_OS_IPHONE
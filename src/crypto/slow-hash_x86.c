@@ -165,6 +165,142 @@ static void (*const extra_hashes[4])(const void *, size_t, unsigned char *) =
 #define AESNI
 #include "slow-hash_x86.inl"
 
+// Two hashes with separate scratchpads, steps of both are interleaved so that latencies of AES
+// and of random scratchpad access in one hash are hidden behind work on the other
+static void cn_slow_hash2_aesni(void *restrict context1, void *restrict context2, const void *data1, size_t length1,
+    const void *data2, size_t length2, void *hash1, void *hash2)
+{
+  struct cn_ctx *ctxs[2] = {(struct cn_ctx *) context1, (struct cn_ctx *) context2};
+  void *hash[2] = {hash1, hash2};
+  ALIGNED_DECL(uint8_t ExpandedKey[2][256], 16);
+  ALIGNED_DECL(uint64_t a[2][2], 16);
+  __m128i *longoutput[2], *expkey[2], *xmminput[2], b_x[2];
+  size_t i, j, k;
+
+  hash_process(&ctxs[0]->state.hs, (const uint8_t*) data1, length1);
+  hash_process(&ctxs[1]->state.hs, (const uint8_t*) data2, length2);
+  for (k = 0; k < 2; k++)
+  {
+    memcpy(ctxs[k]->text, ctxs[k]->state.init, INIT_SIZE_BYTE);
+    memcpy(ExpandedKey[k], ctxs[k]->state.hs.b, AES_KEY_SIZE);
+    ExpandAESKey256(ExpandedKey[k]);
+    longoutput[k] = (__m128i *) ctxs[k]->long_state;
+    expkey[k] = (__m128i *) ExpandedKey[k];
+    xmminput[k] = (__m128i *) ctxs[k]->text;
+  }
+
+  for (i = 0; likely(i < MEMORY); i += INIT_SIZE_BYTE)
+  {
+    for (j = 0; j < 10; j++)
+      for (k = 0; k < 2; k++)
+      {
+        xmminput[k][0] = _mm_aesenc_si128(xmminput[k][0], expkey[k][j]);
+        xmminput[k][1] = _mm_aesenc_si128(xmminput[k][1], expkey[k][j]);
+        xmminput[k][2] = _mm_aesenc_si128(xmminput[k][2], expkey[k][j]);
+        xmminput[k][3] = _mm_aesenc_si128(xmminput[k][3], expkey[k][j]);
+        xmminput[k][4] = _mm_aesenc_si128(xmminput[k][4], expkey[k][j]);
+        xmminput[k][5] = _mm_aesenc_si128(xmminput[k][5], expkey[k][j]);
+        xmminput[k][6] = _mm_aesenc_si128(xmminput[k][6], expkey[k][j]);
+        xmminput[k][7] = _mm_aesenc_si128(xmminput[k][7], expkey[k][j]);
+      }
+    for (k = 0; k < 2; k++)
+      for (j = 0; j < 8; j++)
+        _mm_store_si128(&(longoutput[k][(i >> 4) + j]), xmminput[k][j]);
+  }
+
+  for (k = 0; k < 2; k++)
+  {
+    for (i = 0; i < 2; i++)
+    {
+      ctxs[k]->a[i] = ((uint64_t *)ctxs[k]->state.k)[i] ^  ((uint64_t *)ctxs[k]->state.k)[i+4];
+      ctxs[k]->b[i] = ((uint64_t *)ctxs[k]->state.k)[i+2] ^  ((uint64_t *)ctxs[k]->state.k)[i+6];
+    }
+    b_x[k] = _mm_load_si128((__m128i *)ctxs[k]->b);
+    a[k][0] = ctxs[k]->a[0];
+    a[k][1] = ctxs[k]->a[1];
+  }
+
+  for(i = 0; likely(i < 0x80000); i++)
+  {
+    uint8_t *long_state0 = ctxs[0]->long_state, *long_state1 = ctxs[1]->long_state;
+    __m128i c_x0 = _mm_load_si128((__m128i *)&long_state0[a[0][0] & 0x1FFFF0]);
+    __m128i c_x1 = _mm_load_si128((__m128i *)&long_state1[a[1][0] & 0x1FFFF0]);
+    ALIGNED_DECL(uint64_t c[2][2], 16);
+    uint64_t b[2][2], hi, lo, *nextblock;
+
+    c_x0 = _mm_aesenc_si128(c_x0, _mm_load_si128((__m128i *)a[0]));
+    c_x1 = _mm_aesenc_si128(c_x1, _mm_load_si128((__m128i *)a[1]));
+    _mm_store_si128((__m128i *)c[0], c_x0);
+    _mm_store_si128((__m128i *)c[1], c_x1);
+    _mm_store_si128((__m128i *)&long_state0[a[0][0] & 0x1FFFF0], _mm_xor_si128(b_x[0], c_x0));
+    _mm_store_si128((__m128i *)&long_state1[a[1][0] & 0x1FFFF0], _mm_xor_si128(b_x[1], c_x1));
+    b_x[0] = c_x0;
+    b_x[1] = c_x1;
+
+    nextblock = (uint64_t *)&long_state0[c[0][0] & 0x1FFFF0];
+    b[0][0] = nextblock[0];
+    b[0][1] = nextblock[1];
+    lo = mul128(c[0][0], b[0][0], &hi);
+    a[0][0] += hi;
+    a[0][1] += lo;
+    nextblock[0] = a[0][0];
+    nextblock[1] = a[0][1];
+    a[0][0] ^= b[0][0];
+    a[0][1] ^= b[0][1];
+
+    nextblock = (uint64_t *)&long_state1[c[1][0] & 0x1FFFF0];
+    b[1][0] = nextblock[0];
+    b[1][1] = nextblock[1];
+    lo = mul128(c[1][0], b[1][0], &hi);
+    a[1][0] += hi;
+    a[1][1] += lo;
+    nextblock[0] = a[1][0];
+    nextblock[1] = a[1][1];
+    a[1][0] ^= b[1][0];
+    a[1][1] ^= b[1][1];
+  }
+
+  for (k = 0; k < 2; k++)
+  {
+    memcpy(ctxs[k]->text, ctxs[k]->state.init, INIT_SIZE_BYTE);
+    memcpy(ExpandedKey[k], &ctxs[k]->state.hs.b[32], AES_KEY_SIZE);
+    ExpandAESKey256(ExpandedKey[k]);
+  }
+
+  for (i = 0; likely(i < MEMORY); i += INIT_SIZE_BYTE)
+  {
+    for (k = 0; k < 2; k++)
+      for (j = 0; j < 8; j++)
+        xmminput[k][j] = _mm_xor_si128(longoutput[k][(i >> 4) + j], xmminput[k][j]);
+    for (j = 0; j < 10; j++)
+      for (k = 0; k < 2; k++)
+      {
+        xmminput[k][0] = _mm_aesenc_si128(xmminput[k][0], expkey[k][j]);
+        xmminput[k][1] = _mm_aesenc_si128(xmminput[k][1], expkey[k][j]);
+        xmminput[k][2] = _mm_aesenc_si128(xmminput[k][2], expkey[k][j]);
+        xmminput[k][3] = _mm_aesenc_si128(xmminput[k][3], expkey[k][j]);
+        xmminput[k][4] = _mm_aesenc_si128(xmminput[k][4], expkey[k][j]);
+        xmminput[k][5] = _mm_aesenc_si128(xmminput[k][5], expkey[k][j]);
+        xmminput[k][6] = _mm_aesenc_si128(xmminput[k][6], expkey[k][j]);
+        xmminput[k][7] = _mm_aesenc_si128(xmminput[k][7], expkey[k][j]);
+      }
+  }
+
+  for (k = 0; k < 2; k++)
+  {
+    memcpy(ctxs[k]->state.init, ctxs[k]->text, INIT_SIZE_BYTE);
+    hash_permutation(&ctxs[k]->state.hs);
+    extra_hashes[ctxs[k]->state.hs.b[0] & 3](&ctxs[k]->state, 200, hash[k]);
+  }
+}
+
+static void cn_slow_hash2_noaesni(void *context1, void *context2, const void *data1, size_t length1,
+    const void *data2, size_t length2, void *hash1, void *hash2)
+{
+  cn_slow_hash_noaesni(context1, data1, length1, hash1);
+  cn_slow_hash_noaesni(context2, data2, length2, hash2);
+}
+
 static int cpu_has_aesni(void){
   int ecx;
 #if defined(_MSC_VER)
@@ -191,9 +327,27 @@ void cn_slow_hash(void * a, const void * b, size_t c, void * d){
   (*cn_slow_hash_fp)(a, b, c, d);
 }
 
-// If INITIALIZER fails to compile on your platform, just comment out 3 lines below
+static void cn_slow_hash2_runtime_aes_check(void *context1, void *context2, const void *data1, size_t length1,
+    const void *data2, size_t length2, void *hash1, void *hash2);
+
+static void (*cn_slow_hash2_fp)(void *, void *, const void *, size_t, const void *, size_t, void *, void *) =
+    cn_slow_hash2_runtime_aes_check;
+
+static void cn_slow_hash2_runtime_aes_check(void *context1, void *context2, const void *data1, size_t length1,
+    const void *data2, size_t length2, void *hash1, void *hash2){
+  cn_slow_hash2_fp = cpu_has_aesni() ? cn_slow_hash2_aesni : cn_slow_hash2_noaesni;
+  cn_slow_hash2_fp(context1, context2, data1, length1, data2, length2, hash1, hash2);
+}
+
+void cn_slow_hash2(void *context1, void *context2, const void *data1, size_t length1, const void *data2,
+    size_t length2, void *hash1, void *hash2){
+  (*cn_slow_hash2_fp)(context1, context2, data1, length1, data2, length2, hash1, hash2);
+}
+
+// If INITIALIZER fails to compile on your platform, just comment out INITIALIZER below
 INITIALIZER(detect_aes) {
   cn_slow_hash_fp = cpu_has_aesni() ? &cn_slow_hash_aesni : &cn_slow_hash_noaesni;
+  cn_slow_hash2_fp = cpu_has_aesni() ? &cn_slow_hash2_aesni : &cn_slow_hash2_noaesni;
 }
 
 #endif // !TARGET_OS_IPHONE
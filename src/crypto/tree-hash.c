@@ -13,6 +13,24 @@
 
 #include "hash-ops.h"
 
+// result[j] = hash(pairs[2j], pairs[2j + 1]), result can point to pairs (each level reuses ints)
+static void hash_pairs(const unsigned char (*pairs)[HASH_SIZE], size_t count, unsigned char (*result)[HASH_SIZE]) {
+  enum { BATCH = 8 };
+  const void *data[BATCH];
+  size_t lengths[BATCH];
+  unsigned char batch_result[BATCH][HASH_SIZE];
+  size_t i, k, n;
+  for (i = 0; i < count; i += n) {
+    n = count - i < BATCH ? count - i : BATCH;
+    for (k = 0; k < n; ++k) {
+      data[k] = pairs[2 * (i + k)];
+      lengths[k] = 2 * HASH_SIZE;
+    }
+    cn_fast_hash_batch(data, lengths, n, batch_result);
+    memcpy(result[i], batch_result, n * HASH_SIZE);
+  }
+}
+
 void tree_hash(const unsigned char (*hashes)[HASH_SIZE], size_t count, unsigned char *root_hash) {
   assert(count > 0);
   if (count == 1) {
@@ -29,15 +47,13 @@ void tree_hash(const unsigned char (*hashes)[HASH_SIZE], size_t count, unsigned
     cnt &= ~(cnt >> 1);
     ints = alloca(cnt * HASH_SIZE);
     memcpy(ints, hashes, (2 * cnt - count) * HASH_SIZE);
-    for (i = 2 * cnt - count, j = 2 * cnt - count; j < cnt; i += 2, ++j) {
-      cn_fast_hash(hashes[i], 2 * HASH_SIZE, ints[j]);
-    }
-    assert(i == count);
+    i = 2 * cnt - count;
+    j = 2 * cnt - count;
+    hash_pairs(hashes + i, cnt - j, ints + j);
+    assert(i + 2 * (cnt - j) == count);
     while (cnt > 2) {
       cnt >>= 1;
-      for (i = 0, j = 0; j < cnt; i += 2, ++j) {
-        cn_fast_hash(ints[i], 2 * HASH_SIZE, ints[j]);
-      }
+      hash_pairs((const unsigned char (*)[HASH_SIZE])ints, cnt, ints);
     }
     cn_fast_hash(ints[0], 2 * HASH_SIZE, root_hash);
   }
@@ -61,6 +61,8 @@ CRYPTO_MAKE_COMPARABLE(crypto, PublicKey, std::memcmp)
 CRYPTO_MAKE_HASHABLE(crypto, KeyImage)
 CRYPTO_MAKE_COMPARABLE(crypto, KeyImage, std::memcmp)
 
+CRYPTO_MAKE_COMPARABLE(crypto, KeyDerivation, std::memcmp)
+
 CRYPTO_MAKE_HASHABLE(crypto, SecretKey)
 CRYPTO_MAKE_COMPARABLE(crypto, SecretKey, crypto::sodium_compare)
 
@@ -44,6 +44,26 @@ static void fix_merge_mining_tag(BlockTemplate &block) {
 	}
 }
 
+// Tries 2 nonces per cn_slow_hash2 call
+static void mine_block(BlockTemplate &block, Difficulty difficulty, crypto::CryptoNightContext &crypto_ctx) {
+	BlockTemplate block2 = block;
+	while (true) {
+		block2.nonce            = block.nonce + 1;
+		BinaryArray hashing_ba  = get_block_long_hashing_data(block);
+		BinaryArray hashing_ba2 = get_block_long_hashing_data(block2);
+		crypto::Hash hash, hash2;
+		crypto_ctx.cn_slow_hash2(
+		    hashing_ba.data(), hashing_ba.size(), hashing_ba2.data(), hashing_ba2.size(), hash, hash2);
+		if (check_hash(hash, difficulty))
+			return;
+		if (check_hash(hash2, difficulty)) {
+			block.nonce = block2.nonce;
+			return;
+		}
+		block.nonce += 2;
+	}
+}
+
 void test_blockchain(common::CommandLine &cmd) {
 	logging::ConsoleLogger logger;
 	Config config(cmd);
@@ -53,7 +73,7 @@ void test_blockchain(common::CommandLine &cmd) {
 	BlockChainState block_chain(logger, config, currency);
 	block_chain.test_print_structure();
 	AccountPublicAddress address;
-	crypto::CryptoNightContext cryptoContext;
+	crypto::CryptoNightContext cryptoContext(2);
 	if (!currency.parse_account_address_string(
 	        "J4pFpnZYwL6Cf1krpKGNH8TSoEMpyPKLVF5U2JdFEDr5ct1FEiFvhey98w3XuL5DpDPhoKHs8Gv2e16Li7tyGHFLM5evK6H", address))
 		throw std::runtime_error("parse_account_address_string failed");
@@ -71,12 +91,7 @@ void test_blockchain(common::CommandLine &cmd) {
 		templates.push_back(block);
 		difficulties.push_back(difficulty);
 		block.nonce = crypto::rand<uint32_t>();
-		while (true) {
-			crypto::Hash hash = get_block_long_hash(block, cryptoContext);
-			if (check_hash(hash, difficulty))
-				break;
-			block.nonce += 1;
-		}
+		mine_block(block, difficulty, cryptoContext);
 		RawBlock rb;
 		api::BlockHeader info;
 		BinaryArray raw_block_template = seria::to_binary(block);
@@ -92,12 +107,7 @@ void test_blockchain(common::CommandLine &cmd) {
 		BlockTemplate block   = templates.at(ha);
 		Difficulty difficulty = difficulties.at(ha);
 		block.nonce           = crypto::rand<uint32_t>();
-		while (true) {
-			crypto::Hash hash = get_block_long_hash(block, cryptoContext);
-			if (check_hash(hash, difficulty))
-				break;
-			block.nonce += 1;
-		}
+		mine_block(block, difficulty, cryptoContext);
 		RawBlock rb;
 		api::BlockHeader info;
 		BinaryArray raw_block_template = seria::to_binary(block);
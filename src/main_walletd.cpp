@@ -47,7 +47,13 @@ Options for built-in jetcashd (run when no --jetcashd-remote-address specified):
   --jetcashd-bind-address=<ip:port>    Interface and port for jetcashd RPC [default: 127.0.0.1:12021].
   --seed-node-address=<ip:port>        Specify list (one or more) of nodes to start connecting to.
   --priority-node-address=<ip:port>    Specify list (one or more) of nodes to connect to and attempt to keep the connection open.
-  --exclusive-node-address=<ip:port>   Specify list (one or more) of nodes to connect to only. All other nodes including seed nodes will be ignored.)";
+  --exclusive-node-address=<ip:port>   Specify list (one or more) of nodes to connect to only. All other nodes including seed nodes will be ignored.
+  --import-threads=<count>             Number of threads preparing blocks when importing blocks.bin [default: all cores].
+  --import-preload-mb=<size>           Memory for blocks prepared ahead when importing blocks.bin, in megabytes [default: 50].
+  --api-threads=<count>                Number of threads finishing heavy API calls (sync_blocks), 0 to use main thread [default: 2].
+  --amount-output-cache                Keep outputs of amounts used for get_random_outputs in memory, speeds up mixin selection.
+  --db-sync=<commit|background>        Wait for disk on every DB commit, or finish sync in background thread (last commit can be lost after OS crash) [default: background].
+  --db-commit-blocks=<count>           Also commit blockchain DB after every <count> added blocks, 0 to commit on timer only [default: 0].)";
 
 static const bool separate_thread_for_jetcashd = true;
 
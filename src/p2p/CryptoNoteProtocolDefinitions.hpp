@@ -75,6 +75,34 @@ struct NOTIFY_REQUEST_TX_POOL {
 		std::vector<crypto::Hash> txs;
 	};
 };
+
+// Compact block relay (P2PProtocolVersion::V2). Block template already contains hashes of all transactions,
+// so receiver takes them from its pool and asks only for missing ones
+struct NOTIFY_NEW_COMPACT_BLOCK {
+	enum { ID = BC_COMMANDS_POOL_BASE + 21 };
+	struct request {
+		BinaryArray block;  // BlockTemplate
+		uint32_t current_blockchain_height = 0;
+		uint32_t hop                       = 0;
+	};
+};
+
+struct NOTIFY_REQUEST_BLOCK_TRANSACTIONS {
+	enum { ID = BC_COMMANDS_POOL_BASE + 22 };
+	struct request {
+		crypto::Hash block_hash;
+		std::vector<uint32_t> indexes;  // in block.transaction_hashes
+	};
+};
+
+struct NOTIFY_RESPONSE_BLOCK_TRANSACTIONS {
+	enum { ID = BC_COMMANDS_POOL_BASE + 23 };
+	struct request {
+		crypto::Hash block_hash;
+		std::vector<uint32_t> indexes;
+		std::vector<BinaryArray> txs;  // in order of indexes
+	};
+};
 }
 
 namespace seria {
@@ -86,4 +114,7 @@ void ser_members(jetcash::NOTIFY_RESPONSE_GET_OBJECTS::request &v, seria::ISeria
 void ser_members(jetcash::NOTIFY_REQUEST_CHAIN::request &v, seria::ISeria &s);
 void ser_members(jetcash::NOTIFY_RESPONSE_CHAIN_ENTRY::request &v, seria::ISeria &s);
 void ser_members(jetcash::NOTIFY_REQUEST_TX_POOL::request &v, seria::ISeria &s);
+void ser_members(jetcash::NOTIFY_NEW_COMPACT_BLOCK::request &v, seria::ISeria &s);
+void ser_members(jetcash::NOTIFY_REQUEST_BLOCK_TRANSACTIONS::request &v, seria::ISeria &s);
+void ser_members(jetcash::NOTIFY_RESPONSE_BLOCK_TRANSACTIONS::request &v, seria::ISeria &s);
 }
@@ -14,6 +14,9 @@ const float NO_INTERNET_RECONNECT_DELAY = 0.5f;  // when network is unreachable,
 
 using namespace jetcash;
 
+const size_t P2PClient::BODY_READ_CHUNK_SIZE;
+const size_t P2PClient::MAX_PREALLOCATED_BODY_SIZE;
+
 P2PClient::P2PClient(size_t header_size, bool incoming, D_handler d_handler)
     : sock([this](bool canread, bool canwrite) { advance_state(true); },
           std::bind(&P2PClient::on_socket_disconnect, this))
@@ -24,9 +27,13 @@ P2PClient::P2PClient(size_t header_size, bool incoming, D_handler d_handler)
 
 void P2PClient::write() {
 	while (!responses.empty()) {
-		responses.front().copy_to(sock);
-		if (responses.front().size() != 0)
-			break;
+		Response &re = responses.front();
+		while (re.position != re.data->size()) {
+			size_t count = sock.write_some(re.data->data() + re.position, re.data->size() - re.position);
+			if (count == 0)
+				return;
+			re.position += count;
+		}
 		responses.pop_front();
 	}
 	if (responses.empty() && waiting_shutdown)
@@ -48,42 +55,52 @@ void P2PClient::read(bool called_from_runloop) {
 			disconnect(ban_reason);
 			return;
 		}
-		receiving_body        = true;
-		receiving_body_stream = common::VectorStream();
+		receiving_body = true;
+		// Length comes from peer, so we allocate as data arrives, except for reasonable bodies of handshaked peers
+		if (handshake_ok() && request_body_length <= MAX_PREALLOCATED_BODY_SIZE)
+			request_body.resize(request_body_length);
+		else
+			request_body.resize(std::min(request_body_length, BODY_READ_CHUNK_SIZE));
+		request_body_received = 0;
 	}
-	while (true) {
-		if (receiving_body_stream.size() > request_body_length)
-			throw std::logic_error("P2PClient::read request_body.size() > request_body_length");
-		size_t max_count = request_body_length - receiving_body_stream.size();
-		buffer.copy_to(receiving_body_stream, max_count);
-		if (receiving_body_stream.size() == request_body_length) {
-			if (called_from_runloop)
-				on_request_ready();
+	// Rest of the buffer, then straight from socket, so big bodies are not copied through buffer
+	while (request_body_received != request_body_length) {
+		if (request_body_received == request_body.size())
+			request_body.resize(std::min(request_body_length, request_body_received + BODY_READ_CHUNK_SIZE));
+		size_t count = buffer.read_some(
+		    request_body.data() + request_body_received, request_body.size() - request_body_received);
+		if (count == 0)
+			count = sock.read_some(
+			    request_body.data() + request_body_received, request_body.size() - request_body_received);
+		if (count == 0)
 			return;
-		}
-		buffer.copy_from(sock);
-		if (buffer.empty())
-			break;
+		request_body_received += count;
 	}
+	if (called_from_runloop)
+		on_request_ready();
 }
 
 bool P2PClient::read_next_request(BinaryArray &header, BinaryArray &body) {
 	advance_state(false);
 	if (!receiving_body)
 		return false;
-	if (receiving_body_stream.size() != request_body_length)
+	if (request_body_received != request_body_length)
 		return false;
 	header                = std::move(request);
-	body                  = std::move(receiving_body_stream.buffer());
+	body                  = std::move(request_body);
 	request               = BinaryArray();
-	receiving_body_stream = common::VectorStream();
+	request_body          = BinaryArray();
 	receiving_body        = false;
 	request_body_length   = 0;
+	request_body_received = 0;
 	return !waiting_shutdown;  // consume input when waiting_shutdown. TODO - implement socket.shutdown_read
 }
 
-void P2PClient::send(BinaryArray &&body) {
-	responses.emplace_back(std::move(body));
+void P2PClient::send(BinaryArray &&body) { send_shared(std::make_shared<const BinaryArray>(std::move(body))); }
+
+void P2PClient::send_shared(const SharedMessage &body) {
+	responses.emplace_back();
+	responses.back().data = body;
 
 	write();
 }
@@ -97,7 +114,8 @@ void P2PClient::disconnect(const std::string &ban_reason) {
 	buffer.clear();
 	receiving_body        = false;
 	request               = BinaryArray();
-	receiving_body_stream = common::VectorStream();
+	request_body          = BinaryArray();
+	request_body_received = 0;
 	responses.clear();
 
 	sock.close();
@@ -135,7 +153,8 @@ void P2P::on_client_disconnected(P2PClient *who, std::string ban_reason) {
 	connect_all();
 }
 
-void P2P::broadcast(P2PClient *exclude_who, const BinaryArray &data, bool incoming, bool outgoing) {
+void P2P::broadcast(P2PClient *exclude_who, BinaryArray &&data, bool incoming, bool outgoing) {
+	const P2PClient::SharedMessage shared_data = std::make_shared<const BinaryArray>(std::move(data));
 	for (int inc = 0; inc != 2; ++inc) {
 		if (!incoming && inc == 0)
 			continue;
@@ -143,12 +162,22 @@ void P2P::broadcast(P2PClient *exclude_who, const BinaryArray &data, bool incomi
 			continue;
 		for (auto &&cli : clients[inc]) {
 			if (cli.first->handshake_ok() && cli.first != exclude_who) {
-				cli.first->send(BinaryArray(data));
+				cli.first->send_shared(shared_data);
 			}
 		}
 	}
 }
 
+void P2P::broadcast(P2PClient *exclude_who, BinaryArray &&data, const client_filter &filter) {
+	const P2PClient::SharedMessage shared_data = std::make_shared<const BinaryArray>(std::move(data));
+	for (int inc = 0; inc != 2; ++inc)
+		for (auto &&cli : clients[inc]) {
+			if (cli.first->handshake_ok() && cli.first != exclude_who && filter(cli.first)) {
+				cli.first->send_shared(shared_data);
+			}
+		}
+}
+
 P2PClient *P2P::find_connecting_client(const NetworkAddress &address) {
 	const bool incoming = false;
 	for (auto &&cli : clients[incoming])
@@ -20,9 +20,12 @@ class P2P;
 
 class P2PClient {
 public:
-	static const int RECOMMENDED_BUFFER_SIZE = 8192;
+	static const int RECOMMENDED_BUFFER_SIZE       = 8192;
+	static const size_t BODY_READ_CHUNK_SIZE       = 65536;
+	static const size_t MAX_PREALLOCATED_BODY_SIZE = 1024 * 1024;
 
 	typedef std::function<void(std::string ban_reason)> D_handler;
+	typedef std::shared_ptr<const BinaryArray> SharedMessage;  // broadcast sends the same buffer to all peers
 
 	explicit P2PClient(size_t header_size, bool incoming, D_handler d_handler);
 
@@ -30,6 +33,7 @@ public:
 	const NetworkAddress &get_address() const { return address; }
 	bool is_incoming() const { return incoming; }
 	virtual void send(BinaryArray &&body);  // We want to make sure to update stats when calling with a base class
+	virtual void send_shared(const SharedMessage &body);
 	void send_shutdown();
 	void disconnect(const std::string &ban_reason);  // empty for no ban
 	bool test_connect(const NetworkAddress &addr);   // for single connects without p2p
@@ -58,11 +62,16 @@ private:
 	BinaryArray request;
 	size_t request_body_length = 0;
 	bool receiving_body        = false;
-	common::VectorStream receiving_body_stream;
+	BinaryArray request_body;  // grows as data arrives, filled directly from socket
+	size_t request_body_received = 0;
 
 	common::CircularBuffer buffer;
 
-	std::deque<common::VectorStream> responses;
+	struct Response {
+		SharedMessage data;
+		size_t position = 0;  // already written
+	};
+	std::deque<Response> responses;
 	bool waiting_shutdown = false;
 };
 
@@ -73,8 +82,10 @@ public:
 	explicit P2P(logging::ILogger &log, const Config &config, PeerDB &peers, client_factory c_factory);
 
 	void broadcast(
-	    P2PClient *exclude_who, const BinaryArray &data, bool incoming, bool outgoing);  // to all, except who
-	void broadcast(P2PClient *exclude_who, const BinaryArray &data) { broadcast(exclude_who, data, true, true); }
+	    P2PClient *exclude_who, BinaryArray &&data, bool incoming, bool outgoing);  // to all, except who
+	void broadcast(P2PClient *exclude_who, BinaryArray &&data) { broadcast(exclude_who, std::move(data), true, true); }
+	typedef std::function<bool(const P2PClient *)> client_filter;
+	void broadcast(P2PClient *exclude_who, BinaryArray &&data, const client_filter &filter);  // to matching
 	P2PClient *find_client(const NetworkAddress &address, bool incoming);
 	P2PClient *find_connecting_client(const NetworkAddress &address);
 	std::vector<NetworkAddress> good_clients(bool incoming) const;
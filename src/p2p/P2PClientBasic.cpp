@@ -55,7 +55,13 @@ std::map<std::pair<uint32_t, bool>, P2PClientBasic::LevinHandlerFunction> P2PCli
     {{NOTIFY_REQUEST_GET_OBJECTS::ID, false},
         levin_method<NOTIFY_REQUEST_GET_OBJECTS::request>(&P2PClientBasic::on_msg_notify_request_objects)},
     {{NOTIFY_RESPONSE_GET_OBJECTS::ID, false},
-        levin_method<NOTIFY_RESPONSE_GET_OBJECTS::request>(&P2PClientBasic::on_msg_notify_request_objects)}};
+        levin_method<NOTIFY_RESPONSE_GET_OBJECTS::request>(&P2PClientBasic::on_msg_notify_request_objects)},
+    {{NOTIFY_NEW_COMPACT_BLOCK::ID, false},
+        levin_method<NOTIFY_NEW_COMPACT_BLOCK::request>(&P2PClientBasic::on_msg_notify_new_compact_block)},
+    {{NOTIFY_REQUEST_BLOCK_TRANSACTIONS::ID, false},
+        levin_method<NOTIFY_REQUEST_BLOCK_TRANSACTIONS::request>(&P2PClientBasic::on_msg_notify_block_transactions)},
+    {{NOTIFY_RESPONSE_BLOCK_TRANSACTIONS::ID, false},
+        levin_method<NOTIFY_RESPONSE_BLOCK_TRANSACTIONS::request>(&P2PClientBasic::on_msg_notify_block_transactions)}};
 
 P2PClientBasic::P2PClientBasic(const Config &config, uint64_t unique_number, bool incoming, D_handler d_handler)
     : P2PClient(LevinProtocol::HEADER_SIZE(), incoming, d_handler)
@@ -75,10 +81,12 @@ void P2PClientBasic::send_timed_sync() {
 	timed_sync_timer.once(TIMED_SYNC_TIMEOUT);
 }
 
-void P2PClientBasic::send(BinaryArray &&body) {
+void P2PClientBasic::send(BinaryArray &&body) { send_shared(std::make_shared<const BinaryArray>(std::move(body))); }
+
+void P2PClientBasic::send_shared(const SharedMessage &body) {
 	timed_sync_timer.once(TIMED_SYNC_TIMEOUT);
-	on_msg_bytes(0, body.size());
-	P2PClient::send(std::move(body));
+	on_msg_bytes(0, body->size());
+	P2PClient::send_shared(body);
 }
 
 Timestamp P2PClientBasic::get_local_time() const { return static_cast<Timestamp>(time(nullptr)); }
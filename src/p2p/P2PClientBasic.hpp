@@ -66,6 +66,9 @@ protected:
 	virtual void on_msg_notify_request_chain(NOTIFY_RESPONSE_CHAIN_ENTRY::request &&) {}
 	virtual void on_msg_notify_request_objects(NOTIFY_REQUEST_GET_OBJECTS::request &&) {}
 	virtual void on_msg_notify_request_objects(NOTIFY_RESPONSE_GET_OBJECTS::request &&) {}
+	virtual void on_msg_notify_new_compact_block(NOTIFY_NEW_COMPACT_BLOCK::request &&) {}
+	virtual void on_msg_notify_block_transactions(NOTIFY_REQUEST_BLOCK_TRANSACTIONS::request &&) {}
+	virtual void on_msg_notify_block_transactions(NOTIFY_RESPONSE_BLOCK_TRANSACTIONS::request &&) {}
 	virtual CORE_SYNC_DATA get_sync_data() const = 0;
 	virtual std::vector<PeerlistEntry> get_peers_to_share() const { return std::vector<PeerlistEntry>(); }
 
@@ -74,6 +77,7 @@ public:
 	int get_version() const { return version; }
 	uint64_t get_unique_number() const { return unique_number; }
 	virtual void send(BinaryArray &&body) override;
+	virtual void send_shared(const SharedMessage &body) override;
 	basic_node_data get_node_data() const;
 	CORE_SYNC_DATA get_last_received_sync_data() const { return last_received_sync_data; }
 	uint64_t get_last_received_unique_number() const { return last_received_unique_number; }
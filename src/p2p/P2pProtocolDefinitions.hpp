@@ -20,7 +20,7 @@ struct network_config {
 	uint32_t send_peerlist_sz        = 0;
 };
 
-enum P2PProtocolVersion : uint8_t { V0 = 0, V1 = 1, CURRENT = V1 };
+enum P2PProtocolVersion : uint8_t { V0 = 0, V1 = 1, V2 = 2, CURRENT = V2 };  // V2 - compact block relay
 
 struct basic_node_data {
 	UUID network_id;
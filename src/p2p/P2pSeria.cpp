@@ -153,25 +153,9 @@ void ser_members(jetcash::COMMAND_REQUEST_NETWORK_STATE::response &v, seria::ISe
 
 // CryptoNoteProtocolDefinitions
 void ser_members(jetcash::RawBlockLegacy &v, seria::ISeria &s) {
-	std::string other_block;
-	std::vector<std::string> other_transactions;
-	if (s.is_input()) {
-		seria::seria_kv("block", other_block, s);
-		seria::seria_kv("txs", other_transactions, s);
-		v.block.reserve(other_block.size());
-		v.transactions.reserve(other_transactions.size());
-		std::copy(other_block.begin(), other_block.end(), std::back_inserter(v.block));
-		std::transform(other_transactions.begin(), other_transactions.end(), std::back_inserter(v.transactions),
-		    [](const std::string &s) { return jetcash::BinaryArray(s.data(), s.data() + s.size()); });
-	} else {
-		other_block.reserve(v.block.size());
-		other_transactions.reserve(v.transactions.size());
-		std::copy(v.block.begin(), v.block.end(), std::back_inserter(other_block));
-		std::transform(v.transactions.begin(), v.transactions.end(), std::back_inserter(other_transactions),
-		    [](jetcash::BinaryArray &s) { return std::string(s.begin(), s.end()); });
-		seria::seria_kv("block", other_block, s);
-		seria::seria_kv("txs", other_transactions, s);
-	}
+	// On wire BinaryArray is the same KV string, so bodies are decoded straight into block and transactions
+	seria_kv("block", v.block, s);
+	seria_kv("txs", v.transactions, s);
 }
 
 void ser_members(jetcash::NOTIFY_NEW_BLOCK::request &v, seria::ISeria &s) {
@@ -180,20 +164,7 @@ void ser_members(jetcash::NOTIFY_NEW_BLOCK::request &v, seria::ISeria &s) {
 	seria_kv("hop", v.hop, s);
 }
 
-void ser_members(jetcash::NOTIFY_NEW_TRANSACTIONS::request &v, seria::ISeria &s) {
-	std::vector<std::string> transactions;
-	if (s.is_input()) {
-		seria::seria_kv("txs", transactions, s);
-		v.txs.reserve(transactions.size());
-		std::transform(transactions.begin(), transactions.end(), std::back_inserter(v.txs),
-		    [](const std::string &s) { return jetcash::BinaryArray(s.data(), s.data() + s.size()); });
-	} else {
-		transactions.reserve(v.txs.size());
-		std::transform(v.txs.begin(), v.txs.end(), std::back_inserter(transactions),
-		    [](const jetcash::BinaryArray &s) { return std::string(s.begin(), s.end()); });
-		seria::seria_kv("txs", transactions, s);
-	}
-}
+void ser_members(jetcash::NOTIFY_NEW_TRANSACTIONS::request &v, seria::ISeria &s) { seria_kv("txs", v.txs, s); }
 
 void ser_members(jetcash::NOTIFY_REQUEST_GET_OBJECTS::request &v, seria::ISeria &s) {
 	serialize_as_binary(v.txs, "txs", s);
@@ -220,4 +191,21 @@ void ser_members(jetcash::NOTIFY_RESPONSE_CHAIN_ENTRY::request &v, seria::ISeria
 void ser_members(jetcash::NOTIFY_REQUEST_TX_POOL::request &v, seria::ISeria &s) {
 	serialize_as_binary(v.txs, "txs", s);
 }
+
+void ser_members(jetcash::NOTIFY_NEW_COMPACT_BLOCK::request &v, seria::ISeria &s) {
+	seria_kv("block", v.block, s);
+	seria_kv("current_blockchain_height", v.current_blockchain_height, s);
+	seria_kv("hop", v.hop, s);
+}
+
+void ser_members(jetcash::NOTIFY_REQUEST_BLOCK_TRANSACTIONS::request &v, seria::ISeria &s) {
+	seria_kv("block_hash", v.block_hash, s);
+	serialize_as_binary(v.indexes, "indexes", s);
+}
+
+void ser_members(jetcash::NOTIFY_RESPONSE_BLOCK_TRANSACTIONS::request &v, seria::ISeria &s) {
+	seria_kv("block_hash", v.block_hash, s);
+	serialize_as_binary(v.indexes, "indexes", s);
+	seria_kv("txs", v.txs, s);
+}
 }
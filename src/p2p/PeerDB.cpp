@@ -39,6 +39,7 @@ PeerDB::PeerDB(const Config &config)
     , db(config.get_data_folder() + "/peer_db", 1024 * 1024 * 128)
     ,  // make sure this is enough for seed node
     commit_timer(std::bind(&PeerDB::db_commit, this)) {
+	db.set_background_sync(config.db_background_sync);
 	read_db(WHITE_LIST, whitelist);
 	read_db(GRAY_LIST, graylist);
 	for (auto &&addr : config.exclusive_nodes) {
@@ -14,3 +14,43 @@ namespace platform {
 typedef DBlmdb DB;
 }
 #endif
+
+#include <cstring>
+#include <stdexcept>
+#include "common/StringView.hpp"
+
+namespace platform {
+// Key assembled on stack for hot read paths, get(key.view(), DB::Value &) then does not allocate
+class DBKey {
+	enum { MAX_SIZE = 128 };
+	char m_data[MAX_SIZE];
+	size_t m_size = 0;
+
+public:
+	DBKey() {}
+	explicit DBKey(const std::string &prefix) { append(prefix); }
+	DBKey &append(const void *data, size_t size) {
+		if (size > MAX_SIZE - m_size)
+			throw std::logic_error("DBKey too long");
+		std::memcpy(m_data + m_size, data, size);
+		m_size += size;
+		return *this;
+	}
+	DBKey &append(const std::string &str) { return append(str.data(), str.size()); }
+	DBKey &append(char c) { return append(&c, 1); }
+	DBKey &append_hex(const void *data, size_t size);  // lowercase, same as common::to_hex
+	common::StringView view() const { return common::StringView(m_data, m_size); }
+};
+
+inline DBKey &DBKey::append_hex(const void *data, size_t size) {
+	static const char digits[] = "0123456789abcdef";
+	if (size > (MAX_SIZE - m_size) / 2)
+		throw std::logic_error("DBKey too long");
+	const unsigned char *p = reinterpret_cast<const unsigned char *>(data);
+	for (size_t i = 0; i != size; ++i) {
+		m_data[m_size++] = digits[p[i] >> 4];
+		m_data[m_size++] = digits[p[i] & 0xf];
+	}
+	return *this;
+}
+}
@@ -3,6 +3,7 @@
 
 #include "DBlmdb.hpp"
 #include <boost/lexical_cast.hpp>
+#include <cstring>
 #include <iostream>
 #include "PathTools.hpp"
 
@@ -24,8 +25,8 @@ platform::lmdb::Env::~Env() {
 	handle = nullptr;
 }
 
-platform::lmdb::Txn::Txn(Env &db_env) {
-	lmdb_check(::mdb_txn_begin(db_env.handle, nullptr, 0, &handle), "mdb_txn_begin ");
+platform::lmdb::Txn::Txn(Env &db_env, unsigned int flags) {
+	lmdb_check(::mdb_txn_begin(db_env.handle, nullptr, flags, &handle), "mdb_txn_begin ");
 }
 
 void platform::lmdb::Txn::commit() {
@@ -43,6 +44,10 @@ platform::lmdb::Dbi::Dbi(Txn &db_txn) {
 	lmdb_check(::mdb_dbi_open(db_txn.handle, nullptr, 0, &handle), "mdb_dbi_open ");
 }
 
+platform::lmdb::Dbi::Dbi(Txn &db_txn, const std::string &name, unsigned int flags) {
+	lmdb_check(::mdb_dbi_open(db_txn.handle, name.c_str(), flags | MDB_CREATE, &handle), "mdb_dbi_open ");
+}
+
 bool platform::lmdb::Dbi::get(Txn &db_txn, MDB_val *const key, MDB_val *const data) {
 	const int rc = ::mdb_get(db_txn.handle, handle, key, data);
 	if (rc != MDB_SUCCESS && rc != MDB_NOTFOUND)
@@ -70,13 +75,61 @@ platform::lmdb::Cur::~Cur() {
 DBlmdb::DBlmdb(const std::string &full_path, uint64_t max_db_size) : full_path(full_path) {
 	std::cout << "lmdb libversion=" << mdb_version(nullptr, nullptr, nullptr) << std::endl;
 	lmdb_check(::mdb_env_set_mapsize(db_env.handle, max_db_size), "mdb_env_set_mapsize ");
+	lmdb_check(::mdb_env_set_maxdbs(db_env.handle, 16), "mdb_env_set_maxdbs ");
 	create_directories_if_necessary(full_path);
 	lmdb_check(::mdb_env_open(db_env.handle, full_path.c_str(), MDB_NOMETASYNC, 0644), "mdb_env_open ");
 	// MDB_NOMETASYNC - We agree to trade chance of losing 1 last transaction for 2x performance boost
+	// set_background_sync(false) turns it off, set_background_sync(true) syncs meta page soon after commit
 	db_txn.reset(new lmdb::Txn(db_env));
 	db_dbi.reset(new lmdb::Dbi(*db_txn));
 }
 
+DBlmdb::~DBlmdb() { stop_sync_thread(); }  // mdb_env_close does not sync, so we must do it before
+
+void DBlmdb::stop_sync_thread() {
+	if (!sync_thread.joinable())
+		return;
+	{
+		std::unique_lock<std::mutex> lock(sync_mu);
+		sync_quit = true;
+		sync_cv.notify_all();
+	}
+	sync_thread.join();
+	const int rc = ::mdb_env_sync(db_env.handle, 1);  // called from destructor, so no throw
+	if (rc != MDB_SUCCESS)
+		std::cout << "mdb_env_sync failed rc=" << rc << std::endl;
+}
+
+void DBlmdb::set_background_sync(bool background) {
+	if (background) {
+		lmdb_check(::mdb_env_set_flags(db_env.handle, MDB_NOMETASYNC, 1), "mdb_env_set_flags ");
+		if (sync_thread.joinable())
+			return;
+		sync_quit   = false;
+		sync_thread = std::thread(&DBlmdb::sync_thread_run, this);
+		return;
+	}
+	stop_sync_thread();
+	lmdb_check(::mdb_env_set_flags(db_env.handle, MDB_NOMETASYNC, 0), "mdb_env_set_flags ");
+}
+
+void DBlmdb::sync_thread_run() {
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(sync_mu);
+			while (!sync_quit && !sync_requested)
+				sync_cv.wait(lock);
+			if (!sync_requested)
+				break;  // quit, stop_sync_thread syncs commits made after this point
+			sync_requested = false;
+		}
+		// mdb_env_sync is safe to call concurrently with write transaction
+		const int rc = ::mdb_env_sync(db_env.handle, 1);
+		if (rc != MDB_SUCCESS)
+			std::cout << "mdb_env_sync failed rc=" << rc << std::endl;
+	}
+}
+
 size_t DBlmdb::test_get_approximate_size() const {
 	MDB_stat sta{};
 	lmdb_check(::mdb_env_stat(db_env.handle, &sta), "mdb_env_stat ");
@@ -150,10 +203,21 @@ DBlmdb::Cursor DBlmdb::rbegin(const std::string &prefix, const std::string &midd
 	return Cursor(lmdb::Cur(*db_txn, *db_dbi), prefix, middle, max_key_size, false);
 }
 
+DBlmdb::Reader::Reader(DBlmdb &db) : db_txn(db.db_env, MDB_RDONLY), db_dbi(*db.db_dbi) {}
+
+bool DBlmdb::Reader::get(common::StringView key, Value &value) {
+	return db_dbi.get(db_txn, lmdb::Val(key.data(), key.size()), value);
+}
+
 void DBlmdb::commit_db_txn() {
 	db_txn->commit();
 	db_txn.reset();
 	db_txn.reset(new lmdb::Txn(db_env));
+	if (sync_thread.joinable()) {
+		std::unique_lock<std::mutex> lock(sync_mu);
+		sync_requested = true;
+		sync_cv.notify_all();
+	}
 }
 
 void DBlmdb::put(const std::string &key, const common::BinaryArray &value, bool nooverwrite) {
@@ -194,7 +258,9 @@ bool DBlmdb::get(const std::string &key, std::string &value) const {
 	return true;
 }
 
-bool DBlmdb::get(const std::string &key, Value &value) const { return db_dbi->get(*db_txn, lmdb::Val(key), value); }
+bool DBlmdb::get(common::StringView key, Value &value) const {
+	return db_dbi->get(*db_txn, lmdb::Val(key.data(), key.size()), value);
+}
 
 void DBlmdb::del(const std::string &key, bool mustexist) {
 	const int rc = ::mdb_del(db_txn->handle, db_dbi->handle, lmdb::Val(key), nullptr);
@@ -205,6 +271,54 @@ void DBlmdb::del(const std::string &key, bool mustexist) {
 		throw lmdb::Error("DBlmdb::del key does not exist " + std::string(key.data(), key.size()));
 }
 
+const std::string DBlmdb::TABLE_PREFIX = "$table/";
+
+DBlmdb::Table DBlmdb::open_table(const std::string &name) {
+	// Handle becomes visible to other transactions after commit, we have only one anyway
+	tables.push_back(std::unique_ptr<lmdb::Dbi>(new lmdb::Dbi(*db_txn, TABLE_PREFIX + name, MDB_INTEGERKEY)));
+	return tables.size() - 1;
+}
+
+void DBlmdb::put(Table ta, uint32_t key, const common::BinaryArray &value, bool nooverwrite) {
+	unsigned int ikey = key;  // MDB_INTEGERKEY requires unsigned int or size_t
+	lmdb::Val temp_value(value.data(), value.size());
+	const int rc = ::mdb_put(db_txn->handle, tables.at(ta)->handle, lmdb::Val(&ikey, sizeof(ikey)), temp_value,
+	    nooverwrite ? MDB_NOOVERWRITE : 0);
+	if (rc != MDB_SUCCESS && rc != MDB_KEYEXIST)
+		throw lmdb::Error("DBlmdb::put failed " + std::to_string(key));
+	if (nooverwrite && rc == MDB_KEYEXIST)
+		throw lmdb::Error("DBlmdb::put failed or nooverwrite key already exists " + std::to_string(key));
+}
+
+bool DBlmdb::get(Table ta, uint32_t key, Value &value) const {
+	unsigned int ikey = key;
+	return tables.at(ta)->get(*db_txn, lmdb::Val(&ikey, sizeof(ikey)), value);
+}
+
+bool DBlmdb::get_last(Table ta, uint32_t &key, common::BinaryArray &value) const {
+	lmdb::Cur cur(*db_txn, *tables.at(ta));
+	lmdb::Val itkey;
+	lmdb::Val data;
+	if (!cur.get(itkey, data, MDB_LAST))
+		return false;
+	unsigned int ikey = 0;
+	if (itkey.size() != sizeof(ikey))
+		throw lmdb::Error("DBlmdb::get_last wrong integer key size " + std::to_string(itkey.size()));
+	memcpy(&ikey, itkey.data(), sizeof(ikey));
+	key = ikey;
+	value.assign(data.data(), data.data() + data.size());
+	return true;
+}
+
+void DBlmdb::del(Table ta, uint32_t key, bool mustexist) {
+	unsigned int ikey = key;
+	const int rc      = ::mdb_del(db_txn->handle, tables.at(ta)->handle, lmdb::Val(&ikey, sizeof(ikey)), nullptr);
+	if (rc != MDB_SUCCESS && rc != MDB_NOTFOUND)
+		throw lmdb::Error("DBlmdb::del failed " + std::to_string(key));
+	if (mustexist && rc == MDB_NOTFOUND)
+		throw lmdb::Error("DBlmdb::del key does not exist " + std::to_string(key));
+}
+
 std::string DBlmdb::to_ascending_key(uint32_t key) {
 	char buf[32] = {};
 	sprintf(buf, "%08X", key);
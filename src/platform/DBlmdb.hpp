@@ -5,10 +5,15 @@
 
 #include <lmdb.h>
 #include <algorithm>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 #include "common/BinaryArray.hpp"
 #include "common/Nocopy.hpp"
+#include "common/StringView.hpp"
 
 namespace platform {
 
@@ -33,13 +38,14 @@ struct Env : private common::Nocopy {
 };
 struct Txn : private common::Nocopy {
 	MDB_txn *handle = nullptr;
-	explicit Txn(Env &db_env);
+	explicit Txn(Env &db_env, unsigned int flags = 0);
 	void commit();
 	~Txn();
 };
 struct Dbi : private common::Nocopy {
 	MDB_dbi handle = 0;
 	explicit Dbi(Txn &db_txn);
+	explicit Dbi(Txn &db_txn, const std::string &name, unsigned int flags);
 	bool get(Txn &db_txn, MDB_val *const key, MDB_val *const data);
 };
 struct Cur : private common::Nocopy {
@@ -60,11 +66,24 @@ class DBlmdb {
 	lmdb::Env db_env;
 	std::unique_ptr<lmdb::Dbi> db_dbi;
 	std::unique_ptr<lmdb::Txn> db_txn;
+	std::vector<std::unique_ptr<lmdb::Dbi>> tables;
+
+	// In background mode env is MDB_NOMETASYNC, meta page is synced by sync_thread after commits
+	std::thread sync_thread;
+	std::mutex sync_mu;
+	std::condition_variable sync_cv;
+	bool sync_requested = false;
+	bool sync_quit      = false;
+	void sync_thread_run();
+	void stop_sync_thread();
 
 public:
 	explicit DBlmdb(const std::string &full_path,
 	    uint64_t max_db_size = 0x8000000000);  // 0.5 Tb default, out of total 4 Tb on windows
+	~DBlmdb();
 
+	// Commits still sync data pages, so after OS crash background mode can lose only the last commit
+	void set_background_sync(bool background);
 	void commit_db_txn();
 	size_t test_get_approximate_size() const;
 	size_t get_approximate_items_count() const;
@@ -75,11 +94,20 @@ public:
 	bool get(const std::string &key, common::BinaryArray &value) const;
 	bool get(const std::string &key, std::string &value) const;
 
-	typedef lmdb::Val Value;
-	bool get(const std::string &key, Value &value) const;
+	typedef lmdb::Val Value;  // points into DB page, valid until next modification or commit
+	bool get(common::StringView key, Value &value) const;
 
 	void del(const std::string &key, bool mustexist);
 
+	// Sub-databases with MDB_INTEGERKEY, for dense indexes like height -> block hash
+	typedef size_t Table;
+	static const std::string TABLE_PREFIX;  // table names are stored in main keyspace, cursors must skip them
+	Table open_table(const std::string &name);
+	void put(Table, uint32_t key, const common::BinaryArray &value, bool nooverwrite);
+	bool get(Table, uint32_t key, Value &value) const;
+	bool get_last(Table, uint32_t &key, common::BinaryArray &value) const;  // false if table is empty
+	void del(Table, uint32_t key, bool mustexist);
+
 	class Cursor {
 		lmdb::Cur db_cur;
 		std::string suffix;
@@ -103,6 +131,17 @@ public:
 	Cursor begin(const std::string &prefix, const std::string &middle = std::string()) const;
 	Cursor rbegin(const std::string &prefix, const std::string &middle = std::string()) const;
 
+	// Read-only snapshot of last commit for worker threads, thread must not have more than one Reader at a time
+	class Reader : private common::Nocopy {
+		lmdb::Txn db_txn;
+		lmdb::Dbi &db_dbi;
+
+	public:
+		explicit Reader(DBlmdb &db);
+		typedef lmdb::Val Value;  // points into DB page, valid while Reader exists
+		bool get(common::StringView key, Value &value);
+	};
+
 	static std::string to_binary_key(const unsigned char *data, size_t size) {
 		std::string result;
 		result.append(reinterpret_cast<const char *>(data), size);
@@ -30,6 +30,8 @@ DBsqlite::DBsqlite(const std::string &full_path, uint64_t max_db_size) : full_pa
 	//	create_directories_if_necessary(full_path);
 	sqlite_check(sqlite3_open(this->full_path.c_str(), &db_dbi.handle), "sqlite3_open ");
 	char *err_msg = nullptr;  // TODO - we leak err_msg
+	sqlite_check(sqlite3_exec(db_dbi.handle, "PRAGMA journal_mode=WAL", 0, 0, &err_msg), err_msg);
+	sqlite_check(sqlite3_exec(db_dbi.handle, "PRAGMA synchronous=FULL", 0, 0, &err_msg), err_msg);
 	sqlite_check(
 	    sqlite3_exec(db_dbi.handle,
 	        "CREATE TABLE IF NOT EXISTS kv_table(kk BLOB PRIMARY KEY COLLATE BINARY, vv BLOB NOT NULL) WITHOUT ROWID",
@@ -53,6 +55,59 @@ DBsqlite::DBsqlite(const std::string &full_path, uint64_t max_db_size) : full_pa
 	// std::cout << "rows=" << get_approximate_items_count() << std::endl;
 }
 
+DBsqlite::~DBsqlite() { stop_sync_thread(); }  // last commits are synced by closing DB
+
+void DBsqlite::stop_sync_thread() {
+	if (!sync_thread.joinable())
+		return;
+	{
+		std::unique_lock<std::mutex> lock(sync_mu);
+		sync_quit = true;
+		sync_cv.notify_all();
+	}
+	sync_thread.join();
+}
+
+void DBsqlite::set_background_sync(bool background) {
+	if (background == sync_thread.joinable())
+		return;
+	char *err_msg = nullptr;  // TODO - we leak err_msg
+	// Pragmas cannot change durability inside transaction
+	sqlite_check(sqlite3_exec(db_dbi.handle, "COMMIT TRANSACTION", 0, 0, &err_msg), err_msg);
+	if (background) {
+		sqlite_check(sqlite3_exec(db_dbi.handle, "PRAGMA synchronous=NORMAL", 0, 0, &err_msg), err_msg);
+		sqlite_check(sqlite3_exec(db_dbi.handle, "PRAGMA wal_autocheckpoint=0", 0, 0, &err_msg), err_msg);
+		sync_quit   = false;
+		sync_thread = std::thread(&DBsqlite::sync_thread_run, this);
+	} else {
+		stop_sync_thread();
+		sqlite_check(sqlite3_exec(db_dbi.handle, "PRAGMA synchronous=FULL", 0, 0, &err_msg), err_msg);
+		sqlite_check(sqlite3_exec(db_dbi.handle, "PRAGMA wal_autocheckpoint=1000", 0, 0, &err_msg), err_msg);
+	}
+	sqlite_check(sqlite3_exec(db_dbi.handle, "BEGIN TRANSACTION", 0, 0, &err_msg), err_msg);
+}
+
+void DBsqlite::sync_thread_run() {
+	sqlite::Dbi sync_dbi;  // connections cannot be shared between threads in our usage
+	if (sqlite3_open(full_path.c_str(), &sync_dbi.handle) != SQLITE_OK) {
+		std::cout << "SQLite sync thread failed to open DB, WAL will be checkpointed on exit" << std::endl;
+		return;
+	}
+	sqlite3_busy_timeout(sync_dbi.handle, 1000);
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(sync_mu);
+			while (!sync_quit && !sync_requested)
+				sync_cv.wait(lock);
+			if (!sync_requested)
+				break;
+			sync_requested = false;
+		}
+		// Passive checkpoint never blocks writer, pages still in use by readers stay in WAL until next time
+		sqlite3_wal_checkpoint_v2(sync_dbi.handle, nullptr, SQLITE_CHECKPOINT_PASSIVE, nullptr, nullptr);
+	}
+}
+
 size_t DBsqlite::test_get_approximate_size() const { return 0; }
 
 size_t DBsqlite::get_approximate_items_count() const {
@@ -149,6 +204,11 @@ void DBsqlite::commit_db_txn() {
 	char *err_msg = nullptr;  // TODO - we leak err_msg
 	sqlite_check(sqlite3_exec(db_dbi.handle, "COMMIT TRANSACTION", 0, 0, &err_msg), err_msg);
 	sqlite_check(sqlite3_exec(db_dbi.handle, "BEGIN TRANSACTION", 0, 0, &err_msg), err_msg);
+	if (sync_thread.joinable()) {
+		std::unique_lock<std::mutex> lock(sync_mu);
+		sync_requested = true;
+		sync_cv.notify_all();
+	}
 }
 
 static void put(sqlite::Stmt &stmt, const std::string &key, const void *data, size_t size) {
@@ -171,7 +231,7 @@ void DBsqlite::put(const std::string &key, const std::string &value, bool noover
 	::put(stmt, key, value.data(), value.size());
 }
 
-static std::pair<const unsigned char *, size_t> get(const sqlite::Stmt &stmt, const std::string &key) {
+static std::pair<const unsigned char *, size_t> get(const sqlite::Stmt &stmt, common::StringView key) {
 	sqlite3_reset(stmt.handle);
 	sqlite_check(
 	    sqlite3_bind_blob(stmt.handle, 1, key.data(), static_cast<int>(key.size()), 0), "DB::get sqlite3_bind_blob 1 ");
@@ -187,6 +247,25 @@ static std::pair<const unsigned char *, size_t> get(const sqlite::Stmt &stmt, co
 	return std::make_pair(da, si);
 }
 
+DBsqlite::Reader::Reader(DBsqlite &db) {
+	sqlite_check(sqlite3_open_v2(db.full_path.c_str(), &db_dbi.handle, SQLITE_OPEN_READONLY, nullptr),
+	    "DB::Reader sqlite3_open_v2 ");
+	sqlite3_busy_timeout(db_dbi.handle, 1000);
+	sqlite_check(sqlite3_prepare_v2(db_dbi.handle, "SELECT kk, vv FROM kv_table WHERE kk = ?", -1, &stmt_get.handle, 0),
+	    "sqlite3_prepare_v2 Reader stmt_get ");
+	char *err_msg = nullptr;  // TODO - we leak err_msg
+	// WAL snapshot is taken on first get and kept until connection is closed
+	sqlite_check(sqlite3_exec(db_dbi.handle, "BEGIN TRANSACTION", 0, 0, &err_msg), err_msg);
+}
+
+bool DBsqlite::Reader::get(common::StringView key, Value &value) {
+	auto result = ::get(stmt_get, key);
+	if (!result.first)
+		return false;
+	value = Value(reinterpret_cast<const char *>(result.first), result.second);
+	return true;
+}
+
 bool DBsqlite::get(const std::string &key, common::BinaryArray &value) const {
 	auto result = ::get(stmt_get, key);
 	if (!result.first)
@@ -203,6 +282,14 @@ bool DBsqlite::get(const std::string &key, std::string &value) const {
 	return true;
 }
 
+bool DBsqlite::get(common::StringView key, Value &value) const {
+	auto result = ::get(stmt_get, key);
+	if (!result.first)
+		return false;
+	value = Value(reinterpret_cast<const char *>(result.first), result.second);
+	return true;
+}
+
 void DBsqlite::del(const std::string &key, bool mustexist) {
 	sqlite3_reset(stmt_del.handle);
 	sqlite_check(sqlite3_bind_blob(stmt_del.handle, 1, key.data(), static_cast<int>(key.size()), 0),
@@ -215,6 +302,79 @@ void DBsqlite::del(const std::string &key, bool mustexist) {
 		throw platform::sqlite::Error("DB::del row does not exits");
 }
 
+const std::string DBsqlite::TABLE_PREFIX = "$table/";
+
+DBsqlite::Table DBsqlite::open_table(const std::string &name) {
+	const std::string sql_name = "kv_" + name;
+	char *err_msg              = nullptr;  // TODO - we leak err_msg
+	sqlite_check(sqlite3_exec(db_dbi.handle,
+	                 ("CREATE TABLE IF NOT EXISTS " + sql_name + "(kk INTEGER PRIMARY KEY, vv BLOB NOT NULL)").c_str(),
+	                 0, 0, &err_msg),
+	    err_msg);
+	std::unique_ptr<IntegerTable> table(new IntegerTable{});
+	auto prepare = [&](sqlite::Stmt &stmt, const std::string &sql) {
+		sqlite_check(sqlite3_prepare_v2(db_dbi.handle, sql.c_str(), -1, &stmt.handle, 0),
+		    ("sqlite3_prepare_v2 " + sql_name + " ").c_str());
+	};
+	prepare(table->stmt_get, "SELECT vv FROM " + sql_name + " WHERE kk = ?");
+	prepare(table->stmt_insert, "INSERT INTO " + sql_name + " (kk, vv) VALUES (?, ?)");
+	prepare(table->stmt_update, "REPLACE INTO " + sql_name + " (kk, vv) VALUES (?, ?)");
+	prepare(table->stmt_del, "DELETE FROM " + sql_name + " WHERE kk = ?");
+	prepare(table->stmt_last, "SELECT kk, vv FROM " + sql_name + " ORDER BY kk DESC LIMIT 1");
+	tables.push_back(std::move(table));
+	return tables.size() - 1;
+}
+
+void DBsqlite::put(Table ta, uint32_t key, const common::BinaryArray &value, bool nooverwrite) {
+	sqlite::Stmt &stmt = nooverwrite ? tables.at(ta)->stmt_insert : tables.at(ta)->stmt_update;
+	sqlite3_reset(stmt.handle);
+	sqlite_check(sqlite3_bind_int64(stmt.handle, 1, key), "DB::put sqlite3_bind_int64 1 ");
+	sqlite_check(sqlite3_bind_blob(stmt.handle, 2, value.data(), static_cast<int>(value.size()), 0),
+	    "DB::put sqlite3_bind_blob 2 ");
+	auto rc = sqlite3_step(stmt.handle);
+	if (rc != SQLITE_DONE)
+		throw platform::sqlite::Error("DB::put failed sqlite3_step in put " + common::to_string(rc));
+}
+
+bool DBsqlite::get(Table ta, uint32_t key, Value &value) const {
+	const sqlite::Stmt &stmt = tables.at(ta)->stmt_get;
+	sqlite3_reset(stmt.handle);
+	sqlite_check(sqlite3_bind_int64(stmt.handle, 1, key), "DB::get sqlite3_bind_int64 1 ");
+	auto rc = sqlite3_step(stmt.handle);
+	if (rc == SQLITE_DONE)
+		return false;
+	if (rc != SQLITE_ROW)
+		throw platform::sqlite::Error("DB::get failed sqlite3_step in get " + common::to_string(rc));
+	auto da = reinterpret_cast<const char *>(sqlite3_column_blob(stmt.handle, 0));
+	value   = Value(da, sqlite3_column_bytes(stmt.handle, 0));
+	return true;
+}
+
+bool DBsqlite::get_last(Table ta, uint32_t &key, common::BinaryArray &value) const {
+	const sqlite::Stmt &stmt = tables.at(ta)->stmt_last;
+	sqlite3_reset(stmt.handle);
+	auto rc = sqlite3_step(stmt.handle);
+	if (rc == SQLITE_DONE)
+		return false;
+	if (rc != SQLITE_ROW)
+		throw platform::sqlite::Error("DB::get_last failed sqlite3_step " + common::to_string(rc));
+	key     = static_cast<uint32_t>(sqlite3_column_int64(stmt.handle, 0));
+	auto da = reinterpret_cast<const unsigned char *>(sqlite3_column_blob(stmt.handle, 1));
+	value.assign(da, da + sqlite3_column_bytes(stmt.handle, 1));
+	return true;
+}
+
+void DBsqlite::del(Table ta, uint32_t key, bool mustexist) {
+	const sqlite::Stmt &stmt = tables.at(ta)->stmt_del;
+	sqlite3_reset(stmt.handle);
+	sqlite_check(sqlite3_bind_int64(stmt.handle, 1, key), "DB::del sqlite3_bind_int64 1 ");
+	auto rc = sqlite3_step(stmt.handle);
+	if (rc != SQLITE_DONE)
+		throw platform::sqlite::Error("DB::del failed sqlite3_step in del " + common::to_string(rc));
+	if (mustexist && sqlite3_changes(db_dbi.handle) != 1)
+		throw platform::sqlite::Error("DB::del row does not exits");
+}
+
 std::string DBsqlite::to_ascending_key(uint32_t key) {
 	char buf[32] = {};
 	sprintf(buf, "%08X", key);
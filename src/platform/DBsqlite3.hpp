@@ -5,10 +5,15 @@
 
 #include <sqlite3.h>
 #include <algorithm>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 #include "common/BinaryArray.hpp"
 #include "common/Nocopy.hpp"
+#include "common/StringView.hpp"
 
 namespace platform {
 
@@ -38,9 +43,30 @@ class DBsqlite {
 	sqlite::Stmt stmt_del;
 	sqlite::Stmt stmt_select_star;
 
+	struct IntegerTable {  // rowid tables, fastest kind in sqlite
+		sqlite::Stmt stmt_get;
+		sqlite::Stmt stmt_insert;
+		sqlite::Stmt stmt_update;
+		sqlite::Stmt stmt_del;
+		sqlite::Stmt stmt_last;
+	};
+	std::vector<std::unique_ptr<IntegerTable>> tables;
+
+	// In background mode commits do not fsync, WAL is checkpointed (and DB file synced) by sync_thread
+	std::thread sync_thread;
+	std::mutex sync_mu;
+	std::condition_variable sync_cv;
+	bool sync_requested = false;
+	bool sync_quit      = false;
+	void sync_thread_run();
+	void stop_sync_thread();
+
 public:
 	explicit DBsqlite(const std::string &full_path, uint64_t max_db_size = 0);  // no max size in sqlite3
+	~DBsqlite();
 
+	// After crash, background mode can lose last commits, but never corrupts DB
+	void set_background_sync(bool background);
 	void commit_db_txn();
 	size_t test_get_approximate_size() const;
 	size_t get_approximate_items_count() const;
@@ -51,11 +77,20 @@ public:
 	bool get(const std::string &key, common::BinaryArray &value) const;
 	bool get(const std::string &key, std::string &value) const;
 
-	typedef std::string Value;
-	//	bool get(const std::string &key, lmdb::Val &value) const;
+	typedef common::StringView Value;  // points into sqlite statement, valid until next get
+	bool get(common::StringView key, Value &value) const;
 
 	void del(const std::string &key, bool mustexist);
 
+	// Sub-databases with integer keys, for dense indexes like height -> block hash
+	typedef size_t Table;
+	static const std::string TABLE_PREFIX;  // for uniformity with DBlmdb, tables are not in main keyspace
+	Table open_table(const std::string &name);
+	void put(Table, uint32_t key, const common::BinaryArray &value, bool nooverwrite);
+	bool get(Table, uint32_t key, Value &value) const;
+	bool get_last(Table, uint32_t &key, common::BinaryArray &value) const;  // false if table is empty
+	void del(Table, uint32_t key, bool mustexist);
+
 	class Cursor {
 		const DBsqlite *const db;
 		sqlite::Stmt stmt_get;
@@ -81,6 +116,17 @@ public:
 	Cursor begin(const std::string &prefix, const std::string &middle = std::string()) const;
 	Cursor rbegin(const std::string &prefix, const std::string &middle = std::string()) const;
 
+	// Read-only snapshot of last commit for worker threads, opens separate connection
+	class Reader : private common::Nocopy {
+		sqlite::Dbi db_dbi;  // destroyed after stmt_get
+		sqlite::Stmt stmt_get;
+
+	public:
+		explicit Reader(DBsqlite &db);
+		typedef common::StringView Value;  // points into sqlite statement, valid until next get
+		bool get(common::StringView key, Value &value);
+	};
+
 	static std::string to_binary_key(const unsigned char *data, size_t size) {
 		std::string result;
 		result.append(reinterpret_cast<const char *>(data), size);
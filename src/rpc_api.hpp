@@ -400,6 +400,24 @@ struct SyncBlocks {  // Used by walletd, block explorer, etc to sync to jetcashd
 	};
 };
 
+// Binary only, used by walletd running on the same host. Blocks are sent exactly as stored by jetcashd
+// and decoded by walletd preparator threads, so jetcashd does no decode-encode roundtrip on its main thread
+struct SyncBlocksRaw {
+	static std::string bin_method() { return "/sync_blocks_raw.bin"; }
+
+	typedef SyncBlocks::Request Request;
+	struct RawSyncBlock {
+		api::BlockHeader header;
+		BinaryArray raw_block;           // RawBlock in binary format
+		BinaryArray raw_global_indices;  // std::vector<std::vector<uint32_t>> in binary format
+	};
+	struct Response {
+		std::vector<RawSyncBlock> blocks;
+		Height start_height = 0;
+		GetStatus::Response status;
+	};
+};
+
 // Signature of this method will stabilize to the end of beta
 struct SyncMemPool {  // Used by walletd sync process
 	static std::string method() { return "sync_mem_pool"; }
@@ -550,6 +568,8 @@ void ser_members(jetcash::api::jetcashd::GetStatus::Response &v, ISeria &s);
 void ser_members(jetcash::api::jetcashd::SyncBlocks::Request &v, ISeria &s);
 void ser_members(jetcash::api::jetcashd::SyncBlocks::SyncBlock &v, ISeria &s);
 void ser_members(jetcash::api::jetcashd::SyncBlocks::Response &v, ISeria &s);
+void ser_members(jetcash::api::jetcashd::SyncBlocksRaw::RawSyncBlock &v, ISeria &s);
+void ser_members(jetcash::api::jetcashd::SyncBlocksRaw::Response &v, ISeria &s);
 void ser_members(jetcash::api::jetcashd::SyncMemPool::Request &v, ISeria &s);
 void ser_members(jetcash::api::jetcashd::SyncMemPool::Response &v, ISeria &s);
 void ser_members(jetcash::api::jetcashd::GetRandomOutputs::Request &v, ISeria &s);
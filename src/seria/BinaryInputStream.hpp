@@ -45,19 +45,19 @@ private:
 };
 
 template<typename T>
-void from_binary(T &obj, const common::BinaryArray &blob) {
-	common::MemoryInputStream stream(blob.data(), blob.size());
+void from_binary(T &obj, const void *data, size_t size) {  // data is not copied, can point into DB page
+	common::MemoryInputStream stream(data, size);
 	BinaryInputStream ba(stream);
 	ba(obj);
 	if (!stream.empty())
 		throw std::runtime_error("Excess data in from_binary " + std::string(typeid(T).name()));
 }
 template<typename T>
+void from_binary(T &obj, const common::BinaryArray &blob) {
+	from_binary(obj, blob.data(), blob.size());
+}
+template<typename T>
 void from_binary(T &obj, const std::string &blob) {
-	common::MemoryInputStream stream(blob.data(), blob.size());
-	BinaryInputStream ba(stream);
-	ba(obj);
-	if (!stream.empty())
-		throw std::runtime_error("Excess data in from_binary " + std::string(typeid(T).name()));
+	from_binary(obj, blob.data(), blob.size());
 }
 }
@@ -39,6 +39,9 @@ public:
 	virtual void seria_v(common::BinaryArray &value) override;
 	virtual void binary(void *value, size_t size) override;
 
+protected:
+	const common::JsonValue *get_value();
+
 private:
 	common::JsonValue value;
 	const common::JsonValue *object_key_value = nullptr;
@@ -46,8 +49,6 @@ private:
 	std::vector<size_t> idxs;
 	std::vector<common::JsonValue::Object::const_iterator> itrs;
 
-	const common::JsonValue *get_value();
-
 	template<typename T>
 	void get_integer(T &v) {
 		const common::JsonValue *val = get_value();
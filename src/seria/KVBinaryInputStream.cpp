@@ -180,8 +180,10 @@ JsonValue parse_binary(common::IInputStream &stream) {
 KVBinaryInputStream::KVBinaryInputStream(common::IInputStream &strm) : JsonInputValue(parse_binary(strm)) {}
 
 void KVBinaryInputStream::seria_v(common::BinaryArray &value) {
-	std::string str;
-	seria_v(str);
+	const JsonValue *val = get_value();  // copy directly, without intermediate std::string
+	if (!val)
+		return;
+	const auto &str = val->get_string();
 	value.assign(str.data(), str.data() + str.size());
 }
 
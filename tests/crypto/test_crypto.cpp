@@ -3,12 +3,14 @@
 
 //#include <cstddef>
 //#include <cstring>
+#include <deque>
 #include <fstream>
 #include <vector>
 
 #include "test_crypto.hpp"
 
 #include "../io.hpp"
+#include "common/StringTools.hpp"
 #include "crypto/crypto-ops.h"
 #include "crypto/crypto.hpp"
 #include "crypto/hash.hpp"
@@ -16,10 +18,81 @@
 
 using namespace std;
 
+namespace {
+struct RingSignatureCase {
+	vector<crypto::PublicKey> vpubs;
+	vector<const crypto::PublicKey *> pubs;
+	vector<crypto::Signature> sigs;
+	crypto::RingSignatureCheck check;
+	bool expected = false;
+};
+}  // anonymous namespace
+
+// Values calculated with ref10 field arithmetic, other field backends must give identical results
+static void test_known_answers() {
+	crypto::SecretKey view_secret_key, tx_secret_key;
+	crypto::hash_to_scalar("view", 4, view_secret_key);
+	crypto::hash_to_scalar("tx", 2, tx_secret_key);
+	crypto::PublicKey tx_public_key, base;
+	crypto::KeyDerivation derivation;
+	crypto::KeyImage key_image;
+	if (!crypto::secret_key_to_public_key(tx_secret_key, tx_public_key) ||
+	    common::pod_to_hex(tx_public_key) != "934f0a8849a96770c1f09103a2c93b4822b7b8af0b90c09cf0ce8d8e1812dafd")
+		throw std::runtime_error("test_crypto known answer secret_key_to_public_key failed");
+	if (!crypto::generate_key_derivation(tx_public_key, view_secret_key, derivation) ||
+	    common::pod_to_hex(derivation) != "8de1919956f35eb8a8fdb987d5a7f9e5c8d5d0d0e8ca1b9eb467621bdfcc22a8")
+		throw std::runtime_error("test_crypto known answer generate_key_derivation failed");
+	if (!crypto::underive_public_key(derivation, 3, tx_public_key, base) ||
+	    common::pod_to_hex(base) != "3a74ff3db32036dc9f7b365c16092db54067746846142e1616360311a2dfea77")
+		throw std::runtime_error("test_crypto known answer underive_public_key failed");
+	crypto::generate_key_image(tx_public_key, tx_secret_key, key_image);
+	if (common::pod_to_hex(key_image) != "b350cf9ef3f97af66e282f9cbb55b00b6bccf0931f4af39cfc3b24825c9e85a2")
+		throw std::runtime_error("test_crypto known answer generate_key_image failed");
+}
+
+// Batch derivations must match single ones, including invalid keys in the middle of batch
+static void test_batch_derivations() {
+	const size_t count = 150;  // more than one ge_tobytes_batch chunk
+	crypto::SecretKey view_secret_key;
+	crypto::PublicKey view_public_key;
+	crypto::random_keypair(view_public_key, view_secret_key);
+	vector<crypto::PublicKey> tx_keys(count);
+	for (size_t i = 0; i != count; ++i)
+		if (i % 7 == 3) {
+			do
+				crypto::generate_random_bytes(sizeof(tx_keys[i].data), tx_keys[i].data);
+			while (crypto::key_isvalid(tx_keys[i]));
+		} else
+			tx_keys[i] = crypto::random_keypair().public_key;
+	vector<crypto::KeyDerivation> derivations(count);
+	crypto::generate_key_derivations(tx_keys.data(), count, view_secret_key, derivations.data());
+	vector<size_t> output_indices(count);
+	vector<crypto::PublicKey> output_keys(count);
+	for (size_t i = 0; i != count; ++i) {
+		crypto::KeyDerivation expected;
+		if (!crypto::generate_key_derivation(tx_keys[i], view_secret_key, expected))
+			expected = crypto::KeyDerivation{};
+		if (expected != derivations[i])
+			throw std::runtime_error("test_crypto generate_key_derivations failed on item " + std::to_string(i));
+		output_indices[i] = i % 5;
+		output_keys[i]    = i % 7 == 3 ? tx_keys[i] : crypto::random_keypair().public_key;
+	}
+	vector<crypto::PublicKey> bases(count);
+	crypto::underive_public_keys(derivations.data(), output_indices.data(), output_keys.data(), count, bases.data());
+	for (size_t i = 0; i != count; ++i) {
+		crypto::PublicKey expected;
+		if (!crypto::underive_public_key(derivations[i], output_indices[i], output_keys[i], expected))
+			expected = crypto::PublicKey{};
+		if (expected != bases[i])
+			throw std::runtime_error("test_crypto underive_public_keys failed on item " + std::to_string(i));
+	}
+}
+
 void test_crypto(const std::string &test_vectors_filename) {
 	fstream input;
 	string cmd;
 	size_t test = 0;
+	deque<RingSignatureCase> ring_signature_cases;  // checked again together in one batch at the end
 	crypto::initialize_random_for_tests();
 	//  if (argc != 2) {
 	//    cerr << "invalid arguments" << endl;
@@ -228,6 +301,18 @@ void test_crypto(const std::string &test_vectors_filename) {
 			if (expected != actual) {
 				goto error;
 			}
+			ring_signature_cases.emplace_back();
+			RingSignatureCase &rsc = ring_signature_cases.back();
+			rsc.vpubs              = std::move(vpubs);
+			rsc.sigs               = std::move(sigs);
+			for (auto &&pub : rsc.vpubs)
+				rsc.pubs.push_back(&pub);
+			rsc.check.prefix_hash = prefix_hash;
+			rsc.check.image       = image;
+			rsc.check.pubs        = rsc.pubs.data();
+			rsc.check.pubs_count  = rsc.pubs.size();
+			rsc.check.sigs        = rsc.sigs.data();
+			rsc.expected          = expected;
 		} else {
 			throw ios_base::failure("Unknown function: " + cmd);
 		}
@@ -236,4 +321,17 @@ void test_crypto(const std::string &test_vectors_filename) {
 		cerr << "Wrong result on test " << test << endl;
 		throw std::runtime_error("test_crypto failed");
 	}
+	vector<crypto::RingSignatureCheck> checks;
+	bool all_expected = true;
+	for (auto &&rsc : ring_signature_cases) {
+		checks.push_back(rsc.check);
+		all_expected = all_expected && rsc.expected;
+	}
+	if (crypto::check_ring_signatures(checks.data(), checks.size(), true) != all_expected)
+		throw std::runtime_error("test_crypto check_ring_signatures batch failed");
+	for (size_t i = 0; i != checks.size(); ++i)
+		if (checks[i].result != ring_signature_cases[i].expected)
+			throw std::runtime_error("test_crypto check_ring_signatures batch failed on item " + std::to_string(i));
+	test_known_answers();
+	test_batch_derivations();
 }
@@ -3,6 +3,7 @@
 
 #include "test_hash.hpp"
 
+#include <algorithm>
 //#include <cstddef>
 #include <fstream>
 //#include <iomanip>
@@ -86,12 +87,76 @@ void test_hash(const char *test_fun_name, const std::string &test_vectors_filena
 	}
 }
 
+static void read_vectors(
+    const std::string &test_vectors_filename, vector<crypto::Hash> &expected, vector<vector<char>> &datas) {
+	fstream input;
+	input.open(test_vectors_filename, ios_base::in);
+	for (;;) {
+		crypto::Hash ex;
+		vector<char> data;
+		input.exceptions(ios_base::badbit);
+		get(input, ex);
+		if (input.rdstate() & ios_base::eofbit) {
+			break;
+		}
+		input.exceptions(ios_base::badbit | ios_base::failbit | ios_base::eofbit);
+		input.clear(input.rdstate());
+		get(input, data);
+		expected.push_back(ex);
+		datas.push_back(std::move(data));
+	}
+}
+
+// Vectors of different lengths hashed together with cn_fast_hash_batch, in all group sizes up to 9
+void test_hash_batch(const std::string &test_vectors_filename) {
+	vector<crypto::Hash> expected;
+	vector<vector<char>> datas;
+	read_vectors(test_vectors_filename, expected, datas);
+	for (size_t group = 1; group <= 9; ++group) {
+		for (size_t start = 0; start < datas.size(); start += group) {
+			const size_t count = std::min(group, datas.size() - start);
+			vector<const void *> ptrs;
+			vector<size_t> lengths;
+			for (size_t i = start; i != start + count; ++i) {
+				ptrs.push_back(datas[i].data());
+				lengths.push_back(datas[i].size());
+			}
+			vector<crypto::Hash> actual(count);
+			crypto::cn_fast_hash_batch(ptrs.data(), lengths.data(), count, actual.data());
+			for (size_t i = 0; i != count; ++i)
+				if (expected[start + i] != actual[i]) {
+					cerr << "Batch hash mismatch on test " << start + i + 1 << " group " << group << endl;
+					throw std::runtime_error("test_hash_batch failed");
+				}
+		}
+	}
+}
+
+// Every vector paired with the next one (and last with first) in cn_slow_hash2
+void test_slow_hash2(const std::string &test_vectors_filename) {
+	vector<crypto::Hash> expected;
+	vector<vector<char>> datas;
+	read_vectors(test_vectors_filename, expected, datas);
+	crypto::CryptoNightContext context2(2);
+	for (size_t i = 0; i != datas.size(); ++i) {
+		const size_t j = (i + 1) % datas.size();
+		crypto::Hash actual1, actual2;
+		context2.cn_slow_hash2(datas[i].data(), datas[i].size(), datas[j].data(), datas[j].size(), actual1, actual2);
+		if (expected[i] != actual1 || expected[j] != actual2) {
+			cerr << "Slow hash2 mismatch on tests " << i + 1 << " and " << j + 1 << endl;
+			throw std::runtime_error("test_slow_hash2 failed");
+		}
+	}
+}
+
 void test_hashes(const std::string &test_vectors_folder) {
 	test_hash("extra-blake", test_vectors_folder + "/tests-extra-blake.txt");
 	test_hash("extra-groestl", test_vectors_folder + "/tests-extra-groestl.txt");
 	test_hash("extra-jh", test_vectors_folder + "/tests-extra-jh.txt");
 	test_hash("extra-skein", test_vectors_folder + "/tests-extra-skein.txt");
 	test_hash("fast", test_vectors_folder + "/tests-fast.txt");
+	test_hash_batch(test_vectors_folder + "/tests-fast.txt");
 	test_hash("slow", test_vectors_folder + "/tests-slow.txt");
+	test_slow_hash2(test_vectors_folder + "/tests-slow.txt");
 	test_hash("tree", test_vectors_folder + "/tests-tree.txt");
 }